@@ -0,0 +1,665 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* Runs a controller and a segment as child processes on this host *
+ * in front of a built-in echo backend, and drives sessions of one *
+ * request and its echoed response through them, in half and full *
+ * duplex mode. Reports throughput, latency percentiles, CPU time  *
+ * and system calls per session and the resident memory of the    *
+ * controller and the segment as JSON on stdout.                   *
+ *                                                                 *
+ * usage: cloudbus-bench [OPTION]...                               */
+#include "../../src/metrics/metrics_histogram.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <system_error>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+#ifndef CONTROLLER_PATH
+#define CONTROLLER_PATH "./controller"
+#endif
+#ifndef SEGMENT_PATH
+#define SEGMENT_PATH "./segment"
+#endif
+namespace {
+    using clock_type = std::chrono::steady_clock;
+    using namespace cloudbus;
+    static void throw_system_error(const std::string& what){
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            what
+        );
+    }
+    struct options {
+        std::size_t sessions = 20000, warmup = 1000, concurrency = 64, size = 1024, workers = 1;
+        std::vector<std::string> modes = {"half_duplex", "full_duplex"};
+        std::string transport = "unix", poller;
+        std::string controller = CONTROLLER_PATH, segment = SEGMENT_PATH;
+        bool verbose = false;
+    };
+    struct endpoint {
+        sockaddr_storage addr;
+        socklen_t len;
+        std::string url;
+    };
+    static endpoint tcp_endpoint(std::uint16_t port){
+        endpoint ep = {};
+        auto *sin = reinterpret_cast<sockaddr_in*>(&ep.addr);
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        sin->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ep.len = sizeof(sockaddr_in);
+        ep.url = "tcp://127.0.0.1:" + std::to_string(port);
+        return ep;
+    }
+    static endpoint unix_endpoint(const std::string& path){
+        endpoint ep = {};
+        auto *sun = reinterpret_cast<sockaddr_un*>(&ep.addr);
+        sun->sun_family = AF_UNIX;
+        if(path.size() >= sizeof(sun->sun_path))
+            throw std::invalid_argument("Invalid socket path: " + path);
+        std::strcpy(sun->sun_path, path.c_str());
+        ep.len = sizeof(sockaddr_un);
+        ep.url = "unix://" + path;
+        return ep;
+    }
+    /* a loopback port that was free a moment ago. */
+    static std::uint16_t free_port(){
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(fd < 0)
+            throw_system_error("Unable to open new socket.");
+        auto ep = tcp_endpoint(0);
+        if(bind(fd, reinterpret_cast<sockaddr*>(&ep.addr), ep.len) ||
+                getsockname(fd, reinterpret_cast<sockaddr*>(&ep.addr), &ep.len))
+            throw_system_error("Unable to find a free port.");
+        close(fd);
+        return ntohs(reinterpret_cast<sockaddr_in*>(&ep.addr)->sin_port);
+    }
+
+    /* Echoes everything it reads back to the sender, on its own *
+     * thread, and closes each connection once the peer has shut *
+     * down its side and the echo has been written.              */
+    class echo_backend {
+        public:
+            echo_backend():
+                _listen{socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)},
+                _epoll{epoll_create1(EPOLL_CLOEXEC)},
+                _stop{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
+            {
+                if(_listen < 0 || _epoll < 0 || _stop < 0)
+                    throw_system_error("Unable to start the echo backend.");
+                _endpoint = tcp_endpoint(0);
+                if(bind(_listen, reinterpret_cast<sockaddr*>(&_endpoint.addr), _endpoint.len) ||
+                        getsockname(_listen, reinterpret_cast<sockaddr*>(&_endpoint.addr), &_endpoint.len) ||
+                        listen(_listen, SOMAXCONN))
+                    throw_system_error("Unable to listen on the echo backend.");
+                _endpoint.url = "tcp://127.0.0.1:" +
+                    std::to_string(ntohs(reinterpret_cast<sockaddr_in*>(&_endpoint.addr)->sin_port));
+                watch(_listen, EPOLLIN, EPOLL_CTL_ADD);
+                watch(_stop, EPOLLIN, EPOLL_CTL_ADD);
+                _thread = std::thread([this](){ run(); });
+            }
+            const endpoint& address() const { return _endpoint; }
+            ~echo_backend(){
+                const std::uint64_t one = 1;
+                if(write(_stop, &one, sizeof(one)) == sizeof(one))
+                    _thread.join();
+                else _thread.detach();
+                for(auto&[fd, c]: _conns)
+                    close(fd);
+                close(_stop);
+                close(_epoll);
+                close(_listen);
+            }
+
+            echo_backend(const echo_backend& other) = delete;
+            echo_backend& operator=(const echo_backend& other) = delete;
+
+        private:
+            struct connection {
+                std::string pending;
+                std::size_t offset;
+                bool eof;
+                std::uint32_t events;
+            };
+            int _listen, _epoll, _stop;
+            endpoint _endpoint;
+            std::unordered_map<int, connection> _conns;
+            std::thread _thread;
+
+            void watch(int fd, std::uint32_t events, int op){
+                epoll_event ev = {};
+                ev.events = events;
+                ev.data.fd = fd;
+                if(epoll_ctl(_epoll, op, fd, &ev))
+                    throw_system_error("Unable to watch a descriptor.");
+            }
+            void handle(int fd, connection& c){
+                std::array<char, 65536> buf;
+                ssize_t len = 0;
+                while(!c.eof && (len = recv(fd, buf.data(), buf.size(), 0)) > 0)
+                    c.pending.append(buf.data(), len);
+                if(!c.eof && (!len || errno != EAGAIN))
+                    c.eof = true;
+                while(c.offset < c.pending.size()) {
+                    if((len = send(fd, c.pending.data()+c.offset, c.pending.size()-c.offset, MSG_NOSIGNAL)) < 0) {
+                        if(errno != EAGAIN)
+                            c.pending.clear();
+                        break;
+                    }
+                    c.offset += len;
+                }
+                if(c.offset >= c.pending.size()) {
+                    c.pending.clear();
+                    c.offset = 0;
+                }
+                if(c.eof && c.pending.empty()) {
+                    close(fd);
+                    _conns.erase(fd);
+                    return;
+                }
+                const std::uint32_t events = (c.eof ? 0U : EPOLLIN) | (c.pending.empty() ? 0U : EPOLLOUT);
+                if(events != c.events)
+                    watch(fd, c.events = events, EPOLL_CTL_MOD);
+            }
+            void run(){
+                std::array<epoll_event, 256> events;
+                while(true) {
+                    int n = epoll_wait(_epoll, events.data(), events.size(), -1);
+                    if(n < 0 && errno != EINTR)
+                        throw_system_error("Unable to wait on the echo backend.");
+                    for(int i=0; i < n; ++i) {
+                        const int fd = events[i].data.fd;
+                        if(fd == _stop)
+                            return;
+                        if(fd == _listen) {
+                            int cfd = -1;
+                            while((cfd = accept4(_listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                                _conns[cfd] = connection{{}, 0, false, EPOLLIN};
+                                watch(cfd, EPOLLIN, EPOLL_CTL_ADD);
+                            }
+                            continue;
+                        }
+                        if(auto it = _conns.find(fd); it != _conns.end())
+                            handle(fd, it->second);
+                    }
+                }
+            }
+    };
+
+    /* A controller or a segment running from a configuration file, *
+     * terminated with the benchmark or when it goes out of scope.   */
+    class child {
+        public:
+            child(const std::string& path, const std::string& config, bool verbose){
+                if((_pid = fork()) < 0)
+                    throw_system_error("Unable to fork.");
+                if(!_pid) {
+                    prctl(PR_SET_PDEATHSIG, SIGTERM);
+                    if(!verbose) {
+                        int null = open("/dev/null", O_RDWR);
+                        dup2(null, STDOUT_FILENO);
+                        dup2(null, STDERR_FILENO);
+                    }
+                    execl(path.c_str(), path.c_str(), "-f", config.c_str(), static_cast<char*>(nullptr));
+                    _exit(127);
+                }
+            }
+            pid_t pid() const { return _pid; }
+            bool running(){
+                if(_pid > 0 && waitpid(_pid, nullptr, WNOHANG) == _pid)
+                    _pid = -1;
+                return _pid > 0;
+            }
+            void stop(){
+                if(!running())
+                    return;
+                kill(_pid, SIGTERM);
+                const auto deadline = clock_type::now() + std::chrono::seconds(5);
+                while(running() && clock_type::now() < deadline)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                if(running()) {
+                    kill(_pid, SIGKILL);
+                    waitpid(_pid, nullptr, 0);
+                    _pid = -1;
+                }
+            }
+            ~child(){ stop(); }
+
+            child(const child& other) = delete;
+            child& operator=(const child& other) = delete;
+
+        private:
+            pid_t _pid;
+    };
+    static void wait_ready(child& c, const endpoint& ep, const std::string& name){
+        const auto deadline = clock_type::now() + std::chrono::seconds(5);
+        while(clock_type::now() < deadline) {
+            if(!c.running())
+                throw std::runtime_error(name + " exited during startup.");
+            int fd = socket(ep.addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if(fd < 0)
+                throw_system_error("Unable to open new socket.");
+            const bool ready = !connect(fd, reinterpret_cast<const sockaddr*>(&ep.addr), ep.len);
+            close(fd);
+            if(ready)
+                return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        throw std::runtime_error(name + " is not listening on " + ep.url + ".");
+    }
+
+    /* CPU time and memory of a process, from /proc. */
+    struct usage {
+        double cpu;
+        std::uint64_t rss_kib, hwm_kib;
+    };
+    static usage read_usage(pid_t pid){
+        usage u = {};
+        const std::string dir = "/proc/" + std::to_string(pid);
+        std::ifstream stat(dir + "/stat");
+        std::string line;
+        std::getline(stat, line);
+        if(auto pos = line.rfind(')'); pos != std::string::npos) {
+            /* utime and stime are the 14th and 15th fields, and *
+             * the fields after the command start at the 3rd.    */
+            std::istringstream is(line.substr(pos+1));
+            std::string field;
+            unsigned long long ticks = 0;
+            for(int i=3; i <= 15 && is >> field; ++i)
+                if(i >= 14)
+                    ticks += std::stoull(field);
+            u.cpu = static_cast<double>(ticks)/sysconf(_SC_CLK_TCK);
+        }
+        std::ifstream status(dir + "/status");
+        while(std::getline(status, line)) {
+            if(!line.compare(0, 6, "VmRSS:"))
+                u.rss_kib = std::stoull(line.substr(6));
+            else if(!line.compare(0, 6, "VmHWM:"))
+                u.hwm_kib = std::stoull(line.substr(6));
+        }
+        return u;
+    }
+
+    /* Counts the system calls that every thread of a process enters, *
+     * with the raw_syscalls:sys_enter tracepoint. The count is -1 if *
+     * tracefs is not mounted or perf events are not permitted.      */
+    class syscall_counter {
+        public:
+            explicit syscall_counter(pid_t pid){
+                static const std::array<const char*, 2> paths = {
+                    "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+                    "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"
+                };
+                std::uint64_t id = 0;
+                for(const auto *path: paths)
+                    if(std::ifstream f(path); f >> id)
+                        break;
+                if(!id)
+                    return;
+                std::error_code ec;
+                for(const auto& task: std::filesystem::directory_iterator("/proc/" + std::to_string(pid) + "/task", ec)) {
+                    perf_event_attr attr = {};
+                    attr.type = PERF_TYPE_TRACEPOINT;
+                    attr.size = sizeof(attr);
+                    attr.config = id;
+                    const pid_t tid = std::stoi(task.path().filename().string());
+                    const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+                    if(fd < 0) {
+                        close();
+                        return;
+                    }
+                    _fds.push_back(fd);
+                }
+            }
+            std::int64_t count() const {
+                if(_fds.empty())
+                    return -1;
+                std::int64_t total = 0;
+                for(auto fd: _fds) {
+                    std::uint64_t n = 0;
+                    if(read(fd, &n, sizeof(n)) != sizeof(n))
+                        return -1;
+                    total += n;
+                }
+                return total;
+            }
+            ~syscall_counter(){ close(); }
+
+            syscall_counter(const syscall_counter& other) = delete;
+            syscall_counter& operator=(const syscall_counter& other) = delete;
+
+        private:
+            void close(){
+                for(auto fd: _fds)
+                    ::close(fd);
+                _fds.clear();
+            }
+            std::vector<int> _fds;
+    };
+
+    struct result {
+        std::size_t sessions, errors;
+        double seconds;
+        histogram latency;
+        std::uint64_t sum_us, max_us;
+    };
+    /* Opens up to concurrency sessions at a time until n sessions *
+     * have finished. Each session writes the payload, reads it    *
+     * back and closes, and its latency runs from connect() to the *
+     * last byte of the echo.                                      */
+    static result drive(const endpoint& ep, const std::string& payload, std::size_t concurrency, std::size_t n){
+        struct session {
+            int fd;
+            clock_type::time_point start;
+            std::size_t sent, received;
+        };
+        result res = {};
+        const int efd = epoll_create1(EPOLL_CLOEXEC);
+        if(efd < 0)
+            throw_system_error("Unable to open epoll instance.");
+        std::vector<session> slots(std::min(concurrency, n), session{-1, {}, 0, 0});
+        std::vector<char> buf(65536);
+        std::size_t started = 0, active = 0;
+        auto watch = [&](std::size_t i, std::uint32_t events, int op){
+            epoll_event ev = {};
+            ev.events = events;
+            ev.data.u64 = i;
+            if(epoll_ctl(efd, op, slots[i].fd, &ev))
+                throw_system_error("Unable to watch a session.");
+        };
+        auto open = [&](std::size_t i){
+            auto& s = slots[i];
+            s = session{socket(ep.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0), clock_type::now(), 0, 0};
+            if(s.fd < 0)
+                throw_system_error("Unable to open new socket.");
+            if(connect(s.fd, reinterpret_cast<const sockaddr*>(&ep.addr), ep.len) && errno != EINPROGRESS)
+                throw_system_error("Unable to connect.");
+            watch(i, EPOLLIN | EPOLLOUT, EPOLL_CTL_ADD);
+            ++started;
+            ++active;
+        };
+        auto finish = [&](std::size_t i, bool ok){
+            auto& s = slots[i];
+            close(s.fd);
+            s.fd = -1;
+            --active;
+            if(ok) {
+                const std::uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now()-s.start).count();
+                res.latency.record(us);
+                res.sum_us += us;
+                res.max_us = std::max(res.max_us, us);
+                ++res.sessions;
+            } else ++res.errors;
+            if(started < n)
+                open(i);
+        };
+        const auto start = clock_type::now();
+        for(std::size_t i=0; i < slots.size(); ++i)
+            open(i);
+        auto progress = clock_type::now();
+        std::array<epoll_event, 256> events;
+        while(active) {
+            int nev = epoll_wait(efd, events.data(), events.size(), 1000);
+            if(nev < 0 && errno != EINTR)
+                throw_system_error("Unable to wait on the sessions.");
+            if(nev > 0)
+                progress = clock_type::now();
+            else if(clock_type::now()-progress > std::chrono::seconds(10)) {
+                std::cerr << "Sessions stalled, giving up on " << n-res.sessions-res.errors << " sessions." << std::endl;
+                for(auto& s: slots)
+                    if(s.fd >= 0)
+                        close(s.fd);
+                res.errors = n-res.sessions;
+                break;
+            }
+            for(int k=0; k < nev; ++k) {
+                const std::size_t i = events[k].data.u64;
+                auto& s = slots[i];
+                bool failed = false, done = false;
+                if(s.sent < payload.size() && (events[k].events & (EPOLLOUT | EPOLLERR))) {
+                    if(auto len = send(s.fd, payload.data()+s.sent, payload.size()-s.sent, MSG_NOSIGNAL); len >= 0) {
+                        if((s.sent += len) == payload.size())
+                            watch(i, EPOLLIN, EPOLL_CTL_MOD);
+                    } else failed = (errno != EAGAIN);
+                }
+                while(!failed && !done && (events[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                    auto len = recv(s.fd, buf.data(), buf.size(), 0);
+                    if(len < 0) {
+                        failed = (errno != EAGAIN);
+                        break;
+                    }
+                    failed = !len || s.received+len > payload.size() ||
+                        std::memcmp(buf.data(), payload.data()+s.received, len);
+                    done = !failed && (s.received += len) == payload.size();
+                }
+                if(failed || done)
+                    finish(i, done);
+            }
+        }
+        res.seconds = std::chrono::duration<double>(clock_type::now()-start).count();
+        close(efd);
+        return res;
+    }
+
+    /* percentiles are rounded up to the top of their bucket. */
+    static std::uint64_t percentile(const result& res, double p){
+        return std::min<std::uint64_t>(res.latency.percentile(p), res.max_us);
+    }
+    static std::string json(const std::string& s){
+        return '"' + s + '"';
+    }
+    static std::string json(const usage& before, const usage& after, std::int64_t syscalls, std::size_t sessions){
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(2)
+            << "{\"cpu_us_per_session\": " << (sessions ? 1e6*(after.cpu-before.cpu)/sessions : 0)
+            << ", \"syscalls_per_session\": ";
+        if(syscalls < 0)
+            os << "null";
+        else os << (sessions ? static_cast<double>(syscalls)/sessions : 0);
+        os
+            << ", \"rss_kib\": " << after.rss_kib
+            << ", \"peak_rss_kib\": " << after.hwm_kib << '}';
+        return os.str();
+    }
+    static std::string run(const options& opts, const std::string& mode, const echo_backend& echo, const std::filesystem::path& dir){
+        const endpoint segment_ep = (opts.transport == "tcp") ?
+                tcp_endpoint(free_port()) : unix_endpoint((dir / "segment.sock").string());
+        const endpoint controller_ep = tcp_endpoint(free_port());
+        auto configure = [&](const std::string& name, const endpoint& bind, const endpoint& backend, bool controller){
+            const auto path = dir / (name + ".ini");
+            std::ofstream f(path);
+            f << "[Cloudbus]\n\n[Bench]\n"
+                << "bind=" << bind.url << '\n'
+                << "backend=" << backend.url << '\n'
+                << "workers=" << opts.workers << '\n';
+            if(controller)
+                f << "mode=" << mode << '\n';
+            if(!opts.poller.empty())
+                f << "poller=" << opts.poller << '\n';
+            if(!f)
+                throw std::runtime_error("Unable to write " + path.string() + ".");
+            return path.string();
+        };
+        std::filesystem::remove(dir / "segment.sock");
+        child segment(opts.segment, configure("segment", segment_ep, echo.address(), false), opts.verbose);
+        wait_ready(segment, segment_ep, "segment");
+        child controller(opts.controller, configure("controller", controller_ep, segment_ep, true), opts.verbose);
+        wait_ready(controller, controller_ep, "controller");
+
+        std::string payload(opts.size, '\0');
+        for(std::size_t i=0; i < payload.size(); ++i)
+            payload[i] = static_cast<char>(i*131+7);
+        if(opts.warmup)
+            drive(controller_ep, payload, opts.concurrency, opts.warmup);
+        syscall_counter csyscalls(controller.pid()), ssyscalls(segment.pid());
+        const auto cbefore = read_usage(controller.pid()), sbefore = read_usage(segment.pid());
+        const auto res = drive(controller_ep, payload, opts.concurrency, opts.sessions);
+        const auto cafter = read_usage(controller.pid()), safter = read_usage(segment.pid());
+        const auto ccalls = csyscalls.count(), scalls = ssyscalls.count();
+        if(!controller.running() || !segment.running())
+            throw std::runtime_error("A Cloudbus component exited during the run.");
+        controller.stop();
+        segment.stop();
+
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(2)
+            << "    {\n"
+            << "      \"mode\": " << json(mode) << ",\n"
+            << "      \"sessions\": " << res.sessions << ",\n"
+            << "      \"errors\": " << res.errors << ",\n"
+            << "      \"seconds\": " << res.seconds << ",\n"
+            << "      \"sessions_per_second\": " << (res.seconds > 0 ? res.sessions/res.seconds : 0) << ",\n"
+            << "      \"mib_per_second\": " << (res.seconds > 0 ? 2.0*res.sessions*opts.size/res.seconds/(1 << 20) : 0) << ",\n"
+            << "      \"latency_us\": {\"mean\": " << (res.sessions ? static_cast<double>(res.sum_us)/res.sessions : 0)
+            << ", \"p50\": " << percentile(res, 50)
+            << ", \"p90\": " << percentile(res, 90)
+            << ", \"p99\": " << percentile(res, 99)
+            << ", \"p999\": " << percentile(res, 99.9)
+            << ", \"max\": " << res.max_us << "},\n"
+            << "      \"controller\": " << json(cbefore, cafter, ccalls, res.sessions) << ",\n"
+            << "      \"segment\": " << json(sbefore, safter, scalls, res.sessions) << "\n"
+            << "    }";
+        return os.str();
+    }
+    static int help(const char *name){
+        std::cout << "Usage: " << name << " [OPTION]...\n"
+            << "Benchmark a controller and a segment in front of an echo backend on this host.\n\n"
+            << "  -n, --sessions      sessions to measure per mode (default 20000).\n"
+            << "  -w, --warmup        sessions to run before measuring (default 1000).\n"
+            << "  -c, --concurrency   sessions open at once (default 64).\n"
+            << "  -s, --size          request and response bytes (default 1024).\n"
+            << "  -m, --mode          half_duplex or full_duplex (default both).\n"
+            << "  -t, --transport     unix or tcp between controller and segment (default unix).\n"
+            << "  -W, --workers       worker threads of each component (default 1).\n"
+            << "  -p, --poller        poller of each component (default the component's).\n"
+            << "      --controller    path to the controller (default " CONTROLLER_PATH ").\n"
+            << "      --segment       path to the segment (default " SEGMENT_PATH ").\n"
+            << "  -v, --verbose       show the components' output.\n"
+            << "      --help          display this help and exit.\n";
+        return 0;
+    }
+}
+int main(int argc, char *argv[]){
+    options opts;
+    int i = 1;
+    try {
+        auto is = [&](const char *s, const char *l){
+            return (s && !std::strcmp(argv[i], s)) || !std::strcmp(argv[i], l);
+        };
+        auto next = [&]() -> std::string {
+            if(++i >= argc)
+                throw std::invalid_argument(argv[i-1]);
+            return argv[i];
+        };
+        for(; i < argc; ++i) {
+            if(is("-n", "--sessions")) {
+                opts.sessions = std::stoul(next());
+            } else if(is("-w", "--warmup")) {
+                opts.warmup = std::stoul(next());
+            } else if(is("-c", "--concurrency")) {
+                opts.concurrency = std::max<std::size_t>(std::stoul(next()), 1);
+            } else if(is("-s", "--size")) {
+                opts.size = std::max<std::size_t>(std::stoul(next()), 1);
+            } else if(is("-m", "--mode")) {
+                opts.modes = {next()};
+                if(opts.modes.front() != "half_duplex" && opts.modes.front() != "full_duplex")
+                    throw std::invalid_argument(argv[i]);
+            } else if(is("-t", "--transport")) {
+                opts.transport = next();
+                if(opts.transport != "unix" && opts.transport != "tcp")
+                    throw std::invalid_argument(argv[i]);
+            } else if(is("-W", "--workers")) {
+                opts.workers = std::max<std::size_t>(std::stoul(next()), 1);
+            } else if(is("-p", "--poller")) {
+                opts.poller = next();
+            } else if(is(nullptr, "--controller")) {
+                opts.controller = next();
+            } else if(is(nullptr, "--segment")) {
+                opts.segment = next();
+            } else if(is("-v", "--verbose")) {
+                opts.verbose = true;
+            } else if(is(nullptr, "--help")) {
+                return help(argv[0]);
+            } else {
+                std::cerr << argv[0] << ": invalid option -- '" << argv[i] << "'\n"
+                    << "Try '" << argv[0] << " --help' for more information.\n";
+                return 1;
+            }
+        }
+    } catch(const std::exception& e) {
+        std::cerr << argv[0] << ": invalid argument -- '" << argv[std::min(i, argc-1)] << "'\n";
+        return 1;
+    }
+    struct rlimit lim = {};
+    if(!getrlimit(RLIMIT_NOFILE, &lim)) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    char tmpl[] = "/tmp/cloudbus-bench.XXXXXX";
+    if(!mkdtemp(tmpl))
+        throw_system_error("Unable to make a temporary directory.");
+    const std::filesystem::path dir = tmpl;
+    int rc = 0;
+    try {
+        echo_backend echo;
+        std::vector<std::string> runs;
+        for(const auto& mode: opts.modes)
+            runs.push_back(run(opts, mode, echo, dir));
+        std::cout << "{\n"
+            << "  \"sessions\": " << opts.sessions << ",\n"
+            << "  \"warmup\": " << opts.warmup << ",\n"
+            << "  \"concurrency\": " << opts.concurrency << ",\n"
+            << "  \"size\": " << opts.size << ",\n"
+            << "  \"transport\": " << json(opts.transport) << ",\n"
+            << "  \"workers\": " << opts.workers << ",\n"
+            << "  \"runs\": [\n";
+        for(std::size_t r=0; r < runs.size(); ++r)
+            std::cout << runs[r] << (r+1 < runs.size() ? ",\n" : "\n");
+        std::cout << "  ]\n}" << std::endl;
+    } catch(const std::exception& e) {
+        std::cerr << argv[0] << ": " << e.what() << std::endl;
+        rc = 1;
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return rc;
+}
@@ -0,0 +1,110 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* Compares finding the stream that owns a ready descriptor by *
+ * scanning the interfaces against the connector's fd index,   *
+ * with half of the streams on each side of the connector.     *
+ *                                                             *
+ * usage: bench-dispatch [connections]                         */
+#include "../../src/connectors.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <system_error>
+#include <sys/resource.h>
+#include <sys/socket.h>
+namespace {
+    using clock_type = std::chrono::steady_clock;
+    using namespace cloudbus;
+    static void throw_system_error(const std::string& what){
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            what
+        );
+    }
+    /* the search connector::_handle() used before the index. */
+    static const interface_base::handle_type *scan(connector_base& c, int fd){
+        for(auto *interfaces: {&c.south(), &c.north()})
+            for(auto& interface: *interfaces)
+                for(auto& hnd: interface.streams())
+                    if(std::get<interface_base::native_handle_type>(hnd) == fd)
+                        return &hnd;
+        return nullptr;
+    }
+    template<class Fn>
+    static double run(const std::vector<int>& fds, Fn&& fn){
+        std::size_t found = 0;
+        const auto start = clock_type::now();
+        for(auto fd: fds)
+            found += fn(fd);
+        const double seconds = std::chrono::duration<double>(clock_type::now()-start).count();
+        if(found != fds.size())
+            throw std::runtime_error("Missing stream.");
+        return 1e9*seconds/fds.size();
+    }
+}
+int main(int argc, char **argv){
+    std::size_t n = 50000;
+    if(argc > 1)
+        n = std::stoul(argv[1]);
+    struct rlimit lim = {};
+    if(getrlimit(RLIMIT_NOFILE, &lim))
+        throw_system_error("Unable to get RLIMIT_NOFILE.");
+    lim.rlim_cur = lim.rlim_max;
+    if(setrlimit(RLIMIT_NOFILE, &lim))
+        throw_system_error("Unable to set RLIMIT_NOFILE.");
+    if(n+64 > lim.rlim_cur) {
+        n = lim.rlim_cur-64;
+        std::cerr << "RLIMIT_NOFILE caps the run at " << n << " connections." << std::endl;
+    }
+    const config::section section = {
+        {"bind", "tcp://127.0.0.1:0"},
+        {"backend", "tcp://127.0.0.1:9"}
+    };
+    connector_base c(section);
+    std::vector<int> fds;
+    fds.reserve(n);
+    for(std::size_t i=0; i < n; ++i) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd < 0)
+            throw_system_error("Unable to open new socket.");
+        auto& interface = (i%2) ? c.south().front() : c.north().front();
+        c.index(interface.make(fd, true), interface);
+        fds.push_back(fd);
+    }
+    std::shuffle(fds.begin(), fds.end(), std::mt19937(n));
+    const std::size_t events = std::min<std::size_t>(fds.size(), 20000);
+    std::vector<int> ready(fds.begin(), fds.begin()+events);
+
+    const double scanned = run(ready, [&](int fd){
+        return scan(c, fd) != nullptr;
+    });
+    const double indexed = run(ready, [&](int fd){
+        connector_base::interface_type *interface = nullptr;
+        interface_base::handle_type hnd;
+        return c.lookup(fd, interface, hnd) != connector_base::NONE;
+    });
+    std::cout << std::setw(12) << "connections"
+        << std::setw(16) << "scan ns/event"
+        << std::setw(16) << "index ns/event" << std::endl;
+    std::cout << std::setw(12) << n << std::fixed << std::setprecision(1)
+        << std::setw(16) << scanned
+        << std::setw(16) << indexed << std::endl;
+    return 0;
+}
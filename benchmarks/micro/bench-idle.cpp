@@ -0,0 +1,105 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* Measures the heap held per connection by a sockstream that is *
+ * freshly accepted, that has exchanged a request and response,  *
+ * and that has been idle long enough for its buffers to be      *
+ * released.                                                     *
+ *                                                               *
+ * usage: bench-idle [connections]                               */
+#include "../../src/io.hpp"
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include <system_error>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+namespace {
+    using sockstream = ::io::streams::sockstream;
+    static void throw_system_error(const std::string& what){
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            what
+        );
+    }
+    static std::size_t heap_in_use(){
+        malloc_trim(0);
+        return mallinfo2().uordblks;
+    }
+    static void report(const std::string& what, std::size_t before, std::size_t after, std::size_t n){
+        const double per = (static_cast<double>(after)-static_cast<double>(before))/n;
+        std::cout << std::left << std::setw(24) << what << std::right
+            << std::setw(14) << std::fixed << std::setprecision(0) << per
+            << " bytes/connection" << std::endl;
+    }
+}
+int main(int argc, char **argv){
+    std::size_t n = 10000;
+    if(argc > 1)
+        n = std::stoul(argv[1]);
+    struct rlimit lim = {};
+    if(getrlimit(RLIMIT_NOFILE, &lim))
+        throw_system_error("Unable to get RLIMIT_NOFILE.");
+    lim.rlim_cur = lim.rlim_max;
+    if(setrlimit(RLIMIT_NOFILE, &lim))
+        throw_system_error("Unable to set RLIMIT_NOFILE.");
+    if(2*n+16 > lim.rlim_cur)
+        n = (lim.rlim_cur-16)/2;
+
+    std::vector<int> peers;
+    std::vector<std::unique_ptr<sockstream> > streams;
+    peers.reserve(n);
+    streams.reserve(n);
+    const std::size_t base = heap_in_use();
+    for(std::size_t i=0; i < n; ++i){
+        int sv[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv))
+            throw_system_error("Unable to open socketpair.");
+        streams.push_back(std::make_unique<sockstream>(sv[0], true));
+        peers.push_back(sv[1]);
+    }
+    const std::size_t accepted = heap_in_use();
+    report("accepted", base, accepted, n);
+
+    const std::string request(512, 'q'), response(2048, 'r');
+    std::string buf(request.size(), '\0');
+    for(std::size_t i=0; i < n; ++i){
+        if(write(peers[i], request.data(), request.size()) != static_cast<ssize_t>(request.size()))
+            throw_system_error("Unable to write request.");
+        auto& s = *streams[i];
+        s.read(buf.data(), buf.size());
+        s.write(response.data(), response.size()).flush();
+        if(s.fail())
+            throw std::runtime_error("Request failed.");
+    }
+    const std::size_t active = heap_in_use();
+    report("after one request", base, active, n);
+
+    /* the first pass clears the activity flag, the second releases.  *
+     * freed blocks stay cached in the thread's pool and are counted.  */
+    for(int pass=0; pass < 2; ++pass)
+        for(auto& s: streams)
+            s->release();
+    const std::size_t idle = heap_in_use();
+    report("idle and released", base, idle, n);
+
+    for(auto fd: peers)
+        close(fd);
+    return 0;
+}
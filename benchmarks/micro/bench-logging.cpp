@@ -0,0 +1,67 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* Times the cost of a log call on the logging threads while   *
+ * several threads log error lines at once, with the records   *
+ * written to /dev/null, and counts the records dropped.       *
+ *                                                             *
+ * usage: bench-logging [threads] [records per thread]         */
+#include "../../src/logging.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+namespace {
+    using clock_type = std::chrono::steady_clock;
+}
+int main(int argc, char **argv){
+    std::size_t nthreads = 4, n = 100000;
+    if(argc > 1)
+        nthreads = std::stoul(argv[1]);
+    if(argc > 2)
+        n = std::stoul(argv[2]);
+    std::ofstream devnull("/dev/null");
+    auto& logger = cloudbus::Logger::getInstance();
+    cloudbus::Logger::setOutputStream(devnull);
+    const std::string message = "northbound socket stream error: Connection reset by peer";
+    std::vector<double> ns(nthreads);
+    std::vector<std::thread> threads;
+    for(std::size_t t=0; t < nthreads; ++t) {
+        threads.emplace_back([&, t](){
+            const auto start = clock_type::now();
+            for(std::size_t i=0; i < n; ++i)
+                logger.error(message);
+            ns[t] = std::chrono::duration<double, std::nano>(clock_type::now()-start).count()/n;
+        });
+    }
+    for(auto& t: threads)
+        t.join();
+    logger.flush();
+    double total = 0;
+    for(auto v: ns)
+        total += v;
+    const double records = static_cast<double>(nthreads*n);
+    std::cout << std::setw(10) << "threads"
+        << std::setw(14) << "ns/call"
+        << std::setw(14) << "dropped %" << std::endl;
+    std::cout << std::setw(10) << nthreads << std::fixed << std::setprecision(1)
+        << std::setw(14) << total/nthreads
+        << std::setw(14) << 100.0*logger.dropped()/records << std::endl;
+    cloudbus::Logger::resetOutputStream();
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* Pipelines small length-prefixed frames through a sockstream   *
+ * and reads them back the way the marshallers do, header first *
+ * then payload with readsome(), so that frames straddle recvs.  *
+ *                                                               *
+ * usage: bench-recv [MiB per run]                               */
+#include "../../src/io.hpp"
+#include <iostream>
+#include <iomanip>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <string>
+#include <vector>
+#include <system_error>
+#include <sys/socket.h>
+#include <unistd.h>
+namespace {
+    using clock_type = std::chrono::steady_clock;
+    using sockstream = ::io::streams::sockstream;
+    static void throw_system_error(const std::string& what){
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            what
+        );
+    }
+    /* Reads exactly len bytes in chunks of at most 256 bytes. */
+    static bool read_chunked(sockstream& s, char *data, std::size_t len){
+        constexpr std::size_t BUFSIZE = 256;
+        while(len){
+            auto gcount = s.readsome(data, std::min(len, BUFSIZE));
+            if(!gcount){
+                if(s.peek() == sockstream::traits_type::eof())
+                    return false;
+                continue;
+            }
+            data += gcount;
+            len -= gcount;
+        }
+        return true;
+    }
+    static double run(std::size_t framelen, std::size_t nframes){
+        int sv[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv))
+            throw_system_error("Unable to open socketpair.");
+        std::thread writer([&](){
+            /* odd batch sizes so that frames straddle writes. */
+            std::vector<char> batch;
+            for(std::size_t i=0; i < 37; ++i){
+                const std::uint32_t len = framelen;
+                batch.insert(batch.end(), reinterpret_cast<const char*>(&len), reinterpret_cast<const char*>(&len)+sizeof(len));
+                batch.insert(batch.end(), framelen, 'x');
+            }
+            for(std::size_t sent = 0; sent < nframes; sent += 37){
+                const char *p = batch.data();
+                for(std::size_t rem = batch.size(); rem; ){
+                    auto n = write(sv[1], p, std::min<std::size_t>(rem, 4093));
+                    if(n < 0)
+                        throw_system_error("Unable to write.");
+                    p += n;
+                    rem -= n;
+                }
+            }
+            shutdown(sv[1], SHUT_WR);
+        });
+        std::vector<char> frame(framelen);
+        std::size_t frames = 0;
+        const auto start = clock_type::now();
+        {
+            sockstream s(sv[0], true);
+            std::uint32_t len = 0;
+            while(read_chunked(s, reinterpret_cast<char*>(&len), sizeof(len))){
+                if(len != framelen || !read_chunked(s, frame.data(), len))
+                    throw std::runtime_error("Bad frame.");
+                ++frames;
+            }
+        }
+        const double seconds = std::chrono::duration<double>(clock_type::now()-start).count();
+        writer.join();
+        close(sv[1]);
+        return 1e9*seconds/frames;
+    }
+}
+int main(int argc, char **argv){
+    std::size_t total = 256;
+    if(argc > 1)
+        total = std::stoul(argv[1]);
+    total <<= 20;
+    std::cout << std::setw(10) << "framelen"
+        << std::setw(14) << "ns/frame"
+        << std::setw(14) << "MiB/s" << std::endl;
+    for(std::size_t framelen = 16; framelen <= 4096; framelen *= 4){
+        const std::size_t nframes = total/(framelen+sizeof(std::uint32_t));
+        const double ns = run(framelen, nframes);
+        std::cout << std::setw(10) << framelen << std::fixed << std::setprecision(1)
+            << std::setw(14) << ns
+            << std::setw(14) << (framelen+sizeof(std::uint32_t))/ns*1e9/(1 << 20) << std::endl;
+    }
+    return 0;
+}
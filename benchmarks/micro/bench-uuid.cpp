@@ -0,0 +1,75 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* Compares generating session ids by reading /dev/urandom for *
+ * each id against the per-thread getrandom() pool.             *
+ *                                                              *
+ * usage: bench-uuid [ids per run]                              */
+#include "../../src/messages.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+namespace {
+    using clock_type = std::chrono::steady_clock;
+    using uuid = cloudbus::messages::uuid;
+    /* make_uuid_v7() as it was before the per-thread pool. */
+    static uuid urandom_uuid_v7(){
+        uuid tmp{};
+        if(std::ifstream urnd("/dev/urandom", urnd.in | urnd.binary);
+            urnd.good()
+        ){
+            auto timepoint = std::chrono::system_clock::now().time_since_epoch();
+            std::uint64_t ms_count = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        timepoint).count();
+            tmp.time_low = (ms_count & UINT32_MAX);
+            tmp.time_mid = ((ms_count>>32) & UINT16_MAX);
+            char *start = reinterpret_cast<char*>(&tmp)+offsetof(uuid, time_high_version);
+            urnd.read(start, sizeof(uuid)-offsetof(uuid, time_high_version));
+            tmp.time_high_version &= cloudbus::messages::TIME_HIGH_MAX;
+            tmp.time_high_version |= 0x7000;
+            tmp.clock_seq_reserved &= cloudbus::messages::CLOCK_SEQ_MAX;
+            tmp.clock_seq_reserved |= 0x80;
+        }
+        return tmp;
+    }
+    template<class Fn>
+    static double run(std::size_t n, Fn&& fn){
+        std::size_t sink = 0;
+        const auto start = clock_type::now();
+        for(std::size_t i=0; i < n; ++i)
+            sink += fn().node[0];
+        const double seconds = std::chrono::duration<double>(clock_type::now()-start).count();
+        volatile std::size_t keep = sink;
+        (void)keep;
+        return 1e9*seconds/n;
+    }
+}
+int main(int argc, char **argv){
+    std::size_t n = 200000;
+    if(argc > 1)
+        n = std::stoul(argv[1]);
+    const double urandom = run(n, urandom_uuid_v7);
+    const double pooled = run(n, cloudbus::messages::make_uuid_v7);
+    std::cout << std::setw(10) << "ids"
+        << std::setw(18) << "urandom ns/id"
+        << std::setw(18) << "pooled ns/id" << std::endl;
+    std::cout << std::setw(10) << n << std::fixed << std::setprecision(1)
+        << std::setw(18) << urandom
+        << std::setw(18) << pooled << std::endl;
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* Compares copying and MSG_ZEROCOPY sockbuf sends across message *
+ * sizes to locate the zerocopy= threshold crossover.             *
+ *                                                                *
+ * usage: bench-zerocopy [MiB per run] [host port]                *
+ *                                                                *
+ * By default a local reader thread drains a TCP loopback socket. *
+ * Loopback transmits always fall back to copying, so to measure  *
+ * a real NIC point the benchmark at a remote discard sink, e.g.  *
+ * `nc -lk 9000 >/dev/null`.                                      */
+#include "../../src/io.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <system_error>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include <unistd.h>
+namespace {
+    using clock_type = std::chrono::steady_clock;
+    using sockstream = ::io::streams::sockstream;
+    static void throw_system_error(const std::string& what){
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            what
+        );
+    }
+    static double thread_cputime(){
+        struct rusage usage = {};
+        if(getrusage(RUSAGE_THREAD, &usage))
+            throw_system_error("Unable to get thread resource usage.");
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+            (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec)/1e6;
+    }
+    static int make_connection(const struct sockaddr_in& addr){
+        int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+        if(sockfd < 0)
+            throw_system_error("Unable to open new socket.");
+        if(connect(sockfd, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)))
+            throw_system_error("Unable to connect.");
+        int nodelay = 1;
+        if(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)))
+            throw_system_error("Unable to set TCP_NODELAY.");
+        return sockfd;
+    }
+    struct result {
+        double seconds, cpu;
+    };
+    /* Writes total bytes in msglen sized messages, waiting *
+     * on POLLOUT the way the connectors do.                */
+    static result run(const struct sockaddr_in& addr, int lfd, std::size_t msglen, std::size_t total, std::size_t zerocopy){
+        int sockfd = make_connection(addr);
+        std::thread reader;
+        if(lfd >= 0){
+            int afd = accept(lfd, nullptr, nullptr);
+            if(afd < 0)
+                throw_system_error("Unable to accept connection.");
+            reader = std::thread([afd](){
+                std::vector<char> buf(1 << 20);
+                while(read(afd, buf.data(), buf.size()) > 0);
+                close(afd);
+            });
+        }
+        std::vector<char> message(msglen, 'x');
+        result res = {};
+        {
+            sockstream s(sockfd, true);
+            s.zerocopy() = zerocopy;
+            const double cpu = thread_cputime();
+            const auto start = clock_type::now();
+            for(std::size_t sent = 0; sent < total; sent += msglen){
+                s.write(message.data(), msglen);
+                while(!s.flush().bad() && s.tellp() > 0){
+                    struct pollfd pfd = {sockfd, POLLOUT, 0};
+                    if(poll(&pfd, 1, -1) < 0 && errno != EINTR)
+                        throw_system_error("Unable to poll.");
+                    if(pfd.revents & POLLERR)
+                        s.reap();
+                }
+                if(s.bad())
+                    throw std::runtime_error("Send failed.");
+                s.reap();
+            }
+            res.seconds = std::chrono::duration<double>(clock_type::now()-start).count();
+            res.cpu = thread_cputime()-cpu;
+            shutdown(sockfd, SHUT_WR);
+        }
+        if(reader.joinable())
+            reader.join();
+        return res;
+    }
+}
+int main(int argc, char **argv){
+    std::size_t total = 256;
+    if(argc > 1)
+        total = std::stoul(argv[1]);
+    total <<= 20;
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    int lfd = -1;
+    if(argc > 3){
+        if(inet_pton(AF_INET, argv[2], &addr.sin_addr) != 1)
+            throw std::invalid_argument(std::string("Invalid host: ") + argv[2]);
+        addr.sin_port = htons(std::stoi(argv[3]));
+    } else {
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addrlen = sizeof(addr);
+        if((lfd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+            throw_system_error("Unable to open new socket.");
+        if(bind(lfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen))
+            throw_system_error("Unable to bind.");
+        if(listen(lfd, 1))
+            throw_system_error("Unable to listen.");
+        if(getsockname(lfd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen))
+            throw_system_error("Unable to get socket name.");
+    }
+    std::cout << std::setw(10) << "msglen"
+        << std::setw(14) << "copy MiB/s"
+        << std::setw(14) << "copy cpu%"
+        << std::setw(14) << "zc MiB/s"
+        << std::setw(14) << "zc cpu%" << std::endl;
+    for(std::size_t msglen = 4096; msglen <= (4UL << 20); msglen *= 2){
+        const std::size_t bytes = std::max(total, msglen);
+        auto copy = run(addr, lfd, msglen, bytes, 0);
+        auto zc = run(addr, lfd, msglen, bytes, 1);
+        const double mib = static_cast<double>(bytes)/(1 << 20);
+        std::cout << std::setw(10) << msglen << std::fixed << std::setprecision(1)
+            << std::setw(14) << mib/copy.seconds
+            << std::setw(14) << 100*copy.cpu/copy.seconds
+            << std::setw(14) << mib/zc.seconds
+            << std::setw(14) << 100*zc.cpu/zc.seconds << std::endl;
+    }
+    if(lfd >= 0)
+        close(lfd);
+    return 0;
+}
@@ -0,0 +1,286 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+/* cbstat shows the statistics that running controllers and  *
+ * segments publish to shared memory, refreshed like top.     *
+ *                                                            *
+ * usage: cbstat [-d SECONDS] [-n ITERATIONS] [FILE]...       */
+#include "stats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <unistd.h>
+namespace {
+    using namespace cloudbus;
+    using clock_type = std::chrono::steady_clock;
+    using key_type = std::tuple<std::string, std::size_t, std::uint64_t>;
+    struct sample {
+        clock_type::time_point time;
+        std::uint64_t arrivals, north_bytes, south_bytes;
+        std::uint64_t busy_ns, user_us, system_us, wakeups;
+        std::uint64_t handler_ns[loop_metrics::NHANDLERS];
+    };
+    /* latencies of a backend merged across the threads of a service. */
+    struct merged {
+        histogram ttfb, duration;
+    };
+    /* session phases merged across the threads of a service. */
+    struct phased {
+        histogram phases[stats::NPHASES];
+        std::uint64_t slow;
+    };
+    using samples_type = std::map<key_type, sample>;
+    inline constexpr const char *PHASES[stats::NPHASES] = {"connect", "upload", "think", "download"};
+    inline constexpr const char *HANDLERS[loop_metrics::NHANDLERS] = {
+        "accept", "n.pollin", "n.pollout", "s.pollin", "s.pollout", "resolver", "timers"
+    };
+
+    static std::uint64_t now_ms() {
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+    }
+    static std::vector<std::string> find_files() {
+        std::vector<std::string> files;
+        std::error_code ec;
+        for(const auto& entry: std::filesystem::directory_iterator("/dev/shm", ec))
+            if(entry.path().filename().string().rfind("cloudbus-", 0) == 0)
+                files.push_back(entry.path().string());
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+    static std::string uptime(std::uint64_t started) {
+        const std::uint64_t now = now_ms();
+        std::uint64_t secs = (now > started) ? (now-started)/1000 : 0;
+        std::ostringstream os;
+        os << secs/3600 << ':' << std::setfill('0') << std::setw(2) << (secs/60)%60
+            << ':' << std::setw(2) << secs%60;
+        return os.str();
+    }
+    static double rate(std::uint64_t now, std::uint64_t then, double seconds) {
+        return (seconds > 0 && now >= then) ? (now-then)/seconds : 0;
+    }
+    static std::string usec(histogram::value_type us) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1);
+        if(us < 1000)
+            os << us << "us";
+        else if(us < 1000000)
+            os << us/1e3 << "ms";
+        else os << us/1e6 << 's';
+        return os.str();
+    }
+    static std::string percentiles(const histogram& h) {
+        return "p50 " + usec(h.percentile(50)) +
+            " p99 " + usec(h.percentile(99)) +
+            " p999 " + usec(h.percentile(99.9));
+    }
+    static sample make_sample(const clock_type::time_point& time, const stats::node_record& rec) {
+        sample smp = {
+            time, rec.arrivals, rec.north_bytes, rec.south_bytes,
+            rec.loop.busy_ns, rec.user_us, rec.system_us, rec.loop.wakeups, {}
+        };
+        std::copy(std::begin(rec.loop.handler_ns), std::end(rec.loop.handler_ns), smp.handler_ns);
+        return smp;
+    }
+    /* the share of the interval that a counter of time grew by. */
+    static std::string share(std::uint64_t now, std::uint64_t then, double seconds, double scale) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1) << 100*rate(now, then, seconds)/scale << '%';
+        return os.str();
+    }
+    static std::string counts(const histogram& h) {
+        return "p50 " + std::to_string(h.percentile(50)) +
+            " p99 " + std::to_string(h.percentile(99));
+    }
+    static void show(const std::string& path, samples_type& prev, samples_type& next) {
+        std::unique_ptr<stats::reader> r;
+        try {
+            r = std::make_unique<stats::reader>(path);
+        } catch(const std::exception& e) {
+            std::cerr << "cbstat: " << e.what() << std::endl;
+            return;
+        }
+        const auto& head = r->head();
+        std::cout << path << "  " << head.component << "  pid " << head.pid
+            << "  up " << uptime(head.started)
+            << (r->alive() ? "" : "  (exited)") << '\n'
+            << std::left << std::setw(20) << "SERVICE" << std::right
+            << std::setw(8) << "TID"
+            << std::setw(12) << "ARRIVALS"
+            << std::setw(9) << "ARR/s"
+            << std::setw(8) << "HOPEN"
+            << std::setw(8) << "OPEN"
+            << std::setw(8) << "HCLOSED"
+            << std::setw(8) << "CLOSED"
+            << std::setw(12) << "NORTH B/s"
+            << std::setw(12) << "SOUTH B/s"
+            << std::setw(9) << "POOL%"
+            << std::setw(7) << "AGE" << '\n';
+        const auto time = clock_type::now();
+        std::map<std::pair<std::string, std::string>, merged> services;
+        std::map<std::string, phased> sessions;
+        for(std::size_t i=0; i < r->size(); ++i) {
+            stats::node_record rec;
+            if(!stats::read((*r)[i], rec))
+                continue;
+            const key_type key{path, i, rec.tid};
+            double seconds = 0;
+            const sample current = make_sample(time, rec);
+            sample last = current;
+            if(auto it = prev.find(key); it != prev.end()) {
+                seconds = std::chrono::duration<double>(time - it->second.time).count();
+                last = it->second;
+            }
+            const auto lookups = rec.pool_hits + rec.pool_misses;
+            const auto now = now_ms();
+            rec.service[sizeof(rec.service)-1] = '\0';
+            std::cout << std::left << std::setw(20) << rec.service << std::right
+                << std::setw(8) << rec.tid
+                << std::setw(12) << rec.arrivals
+                << std::fixed << std::setprecision(1)
+                << std::setw(9) << rate(rec.arrivals, last.arrivals, seconds)
+                << std::setw(8) << rec.sessions[stats::HALF_OPEN]
+                << std::setw(8) << rec.sessions[stats::OPEN]
+                << std::setw(8) << rec.sessions[stats::HALF_CLOSED]
+                << std::setw(8) << rec.sessions[stats::CLOSED]
+                << std::setprecision(0)
+                << std::setw(12) << rate(rec.north_bytes, last.north_bytes, seconds)
+                << std::setw(12) << rate(rec.south_bytes, last.south_bytes, seconds)
+                << std::setprecision(1)
+                << std::setw(9) << (lookups ? 100.0*rec.pool_hits/lookups : 0.0)
+                << std::setw(6) << ((now > rec.updated) ? (now-rec.updated)/1000 : 0) << "s\n";
+            const auto& loop = rec.loop;
+            std::cout << "  loop busy " << share(loop.busy_ns, last.busy_ns, seconds, 1e9)
+                << "  usr " << share(rec.user_us, last.user_us, seconds, 1e6)
+                << "  sys " << share(rec.system_us, last.system_us, seconds, 1e6)
+                << "  wakeups " << std::setprecision(1) << rate(loop.wakeups, last.wakeups, seconds) << "/s"
+                << "  timeouts " << loop.timeouts
+                << "  repolls " << loop.repolls << '\n'
+                << "    events " << counts(loop.events)
+                << "  iteration " << percentiles(loop.busy)
+                << "  late " << percentiles(loop.late) << "\n   ";
+            for(std::size_t h=0; h < loop_metrics::NHANDLERS; ++h)
+                std::cout << ' ' << HANDLERS[h] << ' '
+                    << share(loop.handler_ns[h], last.handler_ns[h], seconds, 1e9);
+            std::cout << '\n';
+            for(std::size_t b=0; b < std::min<std::uint64_t>(rec.nbackends, stats::MAX_BACKENDS); ++b) {
+                auto& backend = rec.backends[b];
+                backend.uri[sizeof(backend.uri)-1] = '\0';
+                std::cout << "  " << std::left << std::setw(40) << backend.uri << std::right
+                    << " streams " << backend.streams
+                    << "  outstanding " << backend.outstanding
+                    << "  interarrival " << backend.interarrival << "ms"
+                    << "  intercompletion " << backend.intercompletion << "ms\n";
+                /* only controllers measure latencies. */
+                if(!backend.ttfb.count())
+                    continue;
+                std::cout << "    ttfb " << percentiles(backend.ttfb)
+                    << "  duration " << percentiles(backend.duration) << '\n';
+                auto& m = services[{rec.service, backend.uri}];
+                m.ttfb += backend.ttfb;
+                m.duration += backend.duration;
+            }
+            if(rec.phases[stats::CONNECT].count()) {
+                auto& p = sessions[rec.service];
+                for(std::size_t ph=0; ph < stats::NPHASES; ++ph)
+                    p.phases[ph] += rec.phases[ph];
+                p.slow += rec.slow;
+            }
+            next[key] = current;
+        }
+        if(!services.empty()) {
+            std::cout << "latencies over all threads\n";
+            for(const auto&[name, m]: services)
+                std::cout << std::left << std::setw(20) << name.first << std::right
+                    << ' ' << name.second << '\n'
+                    << "    sessions " << m.duration.count()
+                    << "  ttfb " << percentiles(m.ttfb)
+                    << "  duration " << percentiles(m.duration) << '\n';
+        }
+        if(!sessions.empty()) {
+            std::cout << "session phases over all threads\n";
+            for(const auto&[name, p]: sessions) {
+                std::cout << std::left << std::setw(20) << name << std::right
+                    << " sessions " << p.phases[stats::CONNECT].count()
+                    << "  slow " << p.slow << '\n';
+                for(std::size_t ph=0; ph < stats::NPHASES; ++ph)
+                    std::cout << "    " << std::left << std::setw(9) << PHASES[ph] << std::right
+                        << percentiles(p.phases[ph]) << '\n';
+            }
+        }
+        std::cout << '\n';
+    }
+    static int help(const char *name) {
+        std::cout << "Usage: " << name << " [OPTION]... [FILE]...\n"
+            << "Show the statistics of running Cloudbus components.\n"
+            << "FILE defaults to every /dev/shm/cloudbus-* file.\n\n"
+            << "  -d, --delay        seconds between updates (default 1).\n"
+            << "  -n, --iterations   number of updates before exiting (default forever).\n"
+            << "      --help         display this help and exit.\n";
+        return 0;
+    }
+}
+int main(int argc, char *argv[]) {
+    double delay = 1;
+    long iterations = 0;
+    std::vector<std::string> files;
+    int i = 1;
+    try {
+        for(; i < argc; ++i) {
+            if(!std::strcmp(argv[i], "-d") || !std::strcmp(argv[i], "--delay")) {
+                if(++i < argc)
+                    delay = std::stod(argv[i]);
+            } else if(!std::strcmp(argv[i], "-n") || !std::strcmp(argv[i], "--iterations")) {
+                if(++i < argc)
+                    iterations = std::stol(argv[i]);
+            } else if(!std::strcmp(argv[i], "--help")) {
+                return help(argv[0]);
+            } else if(argv[i][0] == '-') {
+                std::cerr << argv[0] << ": invalid option -- '" << argv[i] << "'\n"
+                    << "Try '" << argv[0] << " --help' for more information.\n";
+                return 1;
+            } else {
+                files.emplace_back(argv[i]);
+            }
+        }
+    } catch(const std::exception& e) {
+        std::cerr << argv[0] << ": invalid argument -- '" << argv[i] << "'\n";
+        return 1;
+    }
+    const bool tty = isatty(STDOUT_FILENO);
+    samples_type prev;
+    for(long n = 0; !iterations || n < iterations; ++n) {
+        if(n)
+            std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+        samples_type next;
+        if(tty)
+            std::cout << "\033[H\033[2J";
+        for(const auto& path: files.empty() ? find_files() : files)
+            show(path, prev, next);
+        std::cout << std::flush;
+        prev.swap(next);
+    }
+    return 0;
+}
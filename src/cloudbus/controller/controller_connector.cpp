@@ -15,6 +15,7 @@
 */
 #include "../../logging.hpp"
 #include "../../metrics.hpp"
+#include "../../trace.hpp"
 #include "controller_connector.hpp"
 #include <tuple>
 #include <sys/un.h>
@@ -24,29 +25,27 @@
 namespace cloudbus {
     namespace controller {
         static constexpr std::streamsize MAX_BUFSIZE = 65536 * 4096; /* 256MiB */
+        static constexpr std::size_t MAX_BATCH = 64; /* frames per readiness event. */
         namespace {
-            template<class T>
-            static bool shrink_to_fit(std::vector<T>& vec){
-                static constexpr std::size_t THRESH = 256;
-                bool resized = false;
-                const std::size_t capacity = vec.capacity();
-                if( capacity > THRESH &&
-                    vec.size() < capacity/8
-                ){
-                    vec  = std::vector<T>(
-                        std::make_move_iterator(vec.begin()),
-                        std::make_move_iterator(vec.end())
-                    );
-                    resized = true;
-                }
-                return resized;
-            }
             static void throw_system_error(const std::string& what) {
                 throw std::system_error(
                     std::error_code(errno, std::system_category()),
                     what
                 );
             }
+            /* MSG_ZEROCOPY completions are queued on the error *
+             * queue, they raise POLLERR but aren't errors.     */
+            template<class StreamPtr>
+            static void reap_zerocopy(const StreamPtr& sp, int sockfd, short& revents){
+                if(!(revents & POLLERR) || sp->reap() < 1)
+                    return;
+                int ec = 0; socklen_t len = sizeof(ec);
+                if(getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &ec, &len))
+                    throw_system_error("Unable to get SO_ERROR.");
+                if(ec)
+                    sp->err() = ec;
+                else revents &= ~POLLERR;
+            }
             static int set_flags(int fd){
                 int flags = 0;
                 if(fcntl(fd, F_SETFD, FD_CLOEXEC))
@@ -57,9 +56,11 @@ namespace cloudbus {
                     throw_system_error("Unable to set the socket to nonblocking mode.");
                 return fd;
             }
-            static int _accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen){
-                int fd = 0;
-                while( (fd = accept(sockfd, addr, addrlen)) < 0 ){
+            /* accepted sockets are already non-blocking and close-on-exec. */
+            template<class StreamPtr>
+            static int _accept(const StreamPtr& sp){
+                int fd = -1;
+                while( (fd = sp->accept()) < 0 ){
                     switch(errno){
                         case EINTR:
                             continue;
@@ -67,12 +68,24 @@ namespace cloudbus {
                             return -errno;
                     }
                 }
-                return set_flags(fd);
+                return fd;
+            }
+            /* the backend of a session and the load on its south stream. */
+            static interface_base *south_load(
+                connector::interfaces& south,
+                const connector::connection_type& conn,
+                interface_base::load_type *&load
+            ){
+                for(auto& sbd: south)
+                    if( (load = sbd.load(conn.south)) )
+                        return &sbd;
+                return nullptr;
             }
             static void state_update(
                 connector::connection_type& conn,
                 const messages::msgtype& type,
-                const connector::connection_type::time_point time
+                const connector::connection_type::time_point time,
+                connector& c
             ){
                 using connection_type = connector::connection_type;
                 auto prev = conn.state;
@@ -89,8 +102,20 @@ namespace cloudbus {
                     default:
                         break;
                 }
-                if(conn.state != prev && conn.state == connection_type::CLOSED)
-                    metrics::get().streams().add_completion(conn.south);
+                if(conn.state == prev)
+                    return;
+                CLOUDBUS_PROBE(session_state, &conn.uuid, prev, conn.state);
+                if(conn.state == connection_type::CLOSED) {
+                    interface_base::load_type *load = nullptr;
+                    if(auto *sbd = south_load(c.south(), conn, load)) {
+                        load->completion(time);
+                        /* sessions aborted by the latch never responded. */
+                        const auto& times = *conn.timestamps;
+                        if(times[connection_type::RESPONSE] != connection_type::time_point())
+                            sbd->record(*load, &interface_base::latency_type::duration, time - times[connection_type::HALF_OPEN]);
+                    }
+                    c.complete(conn);
+                }
             }
             static std::ostream& stream_write(std::ostream& os, std::istream& is){
                 std::array<char, 256> buf;
@@ -132,52 +157,32 @@ namespace cloudbus {
             auto end = std::remove_if(
                     events.begin(), events.end(),
                 [&](auto& ev) {
+                    interface_type *interface = nullptr;
+                    interface_base::handle_type hnd;
                     if(ev.revents) {
-                        auto sit = std::find_if(
-                                south().begin(),
-                                south().end(),
-                            [&](auto& interface){
-                                auto it = std::find_if(
-                                        interface.streams().cbegin(),
-                                        interface.streams().cend(),
-                                    [&](const auto& stream){
-                                        const auto&[ssp, sockfd] = stream;
-                                        if(sockfd==ev.fd && ev.revents & (POLLOUT | POLLERR))
-                                            for(auto& c: connections())
-                                                if(owner_equal(c.south, ssp))
-                                                    if(auto n = c.north.lock(); n && !n->eof())
-                                                        triggers().set(n->native_handle(), POLLIN);
-                                        return sockfd == ev.fd;
-                                    }
-                                );
-                                if(it != interface.streams().cend())
-                                    handled += _handle(static_cast<south_type&>(interface), *it, ev.revents);
-                                return it != interface.streams().cend();
+                        switch(lookup(ev.fd, interface, hnd)) {
+                            case NORTH:
+                            {
+                                const auto& nsp = std::get<north_type::stream_ptr>(hnd);
+                                if(ev.revents & (POLLOUT | POLLERR))
+                                    for(auto& c: connections().north(nsp))
+                                        if(auto s = c.south.lock(); s && !s->eof())
+                                            triggers().set(s->native_handle(), POLLIN);
+                                handled += _handle(static_cast<north_type&>(*interface), hnd, ev.revents);
+                                break;
                             }
-                        );
-                        if(sit == south().end()){
-                            std::find_if(
-                                    north().begin(),
-                                    north().end(),
-                                [&](auto& interface){
-                                    auto it = std::find_if(
-                                            interface.streams().cbegin(),
-                                            interface.streams().cend(),
-                                        [&](const auto& stream){
-                                            const auto&[nsp, sockfd] = stream;
-                                            if(sockfd == ev.fd && ev.revents & (POLLOUT | POLLERR))
-                                                for(auto& c: connections())
-                                                    if(owner_equal(c.north, nsp))
-                                                        if(auto s = c.south.lock(); s && !s->eof())
-                                                            triggers().set(s->native_handle(), POLLIN);
-                                            return sockfd == ev.fd;
-                                        }
-                                    );
-                                    if(it != interface.streams().cend())
-                                        handled += _handle(static_cast<north_type&>(interface), *it, ev.revents);
-                                    return it != interface.streams().cend();
-                                }
-                            );
+                            case SOUTH:
+                            {
+                                const auto& ssp = std::get<south_type::stream_ptr>(hnd);
+                                if(ev.revents & (POLLOUT | POLLERR))
+                                    for(auto& c: connections().south(ssp))
+                                        if(auto n = c.north.lock(); n && !n->eof())
+                                            triggers().set(n->native_handle(), POLLIN);
+                                handled += _handle(static_cast<south_type&>(*interface), hnd, ev.revents);
+                                break;
+                            }
+                            default:
+                                break;
                         }
                     }
                     return !ev.revents;
@@ -186,26 +191,24 @@ namespace cloudbus {
             events.erase(end, events.end());
             return handled + Base::_handle(events);
         }
-        static connector::connections_type::const_iterator write_prepare(
-            connector::connections_type& connections,
-            const connector::north_type::stream_ptr& np,
+        /* true if any southbound stream of the session is backlogged. */
+        template<class Connections>
+        static bool write_prepare(
+            const Connections& connections,
             const std::streamsize& tellp
         ){
             const std::streamsize pos = MAX_BUFSIZE-(tellp+sizeof(messages::msgheader));
-            const auto cbegin=connections.cbegin(), cend=connections.cend();
-            for(auto conn=cbegin; conn != cend; ++conn) {
-                if(owner_equal(conn->north, np)) {
-                    if(auto s = conn->south.lock()) {
-                        if(s->fail())
-                            continue;
-                        if(s->tellp() >= pos && s->flush().bad())
-                            continue;
-                        if(s->tellp() > pos)
-                            return conn;
-                    }
+            for(const auto& conn: connections) {
+                if(auto s = conn.south.lock()) {
+                    if(s->fail())
+                        continue;
+                    if(s->tellp() >= pos && s->flush().bad())
+                        continue;
+                    if(s->tellp() > pos)
+                        return true;
                 }
             }
-            return cend;
+            return false;
         }
         int connector::_route(marshaller_type::north_format& buf, north_type& interface, const north_type::handle_type& stream, event_mask& revents){
             constexpr std::streamsize HDRLEN = sizeof(messages::msgheader);
@@ -216,21 +219,23 @@ namespace cloudbus {
                     {}, {1, static_cast<std::uint16_t>(p+HDRLEN)},
                     {0,0}, {eof ? messages::STOP : messages::DATA, 0}
                 };
-                if(write_prepare(connections(), nsp, p) != connections().cend())
+                if(write_prepare(connections().north(nsp), p))
                     return clear_triggers(nfd, triggers(), revents, (POLLIN | POLLHUP));
                 const auto time = connection_type::clock_type::now();
                 std::size_t connected = 0;
-                for(auto& conn: connections()) {
-                    if(owner_equal(conn.north, nsp)) {
-                        if(auto s = conn.south.lock()) {
-                            if(++connected && conn.state != connection_type::CLOSED){
-                                head.eid = conn.uuid;
-                                s->write(reinterpret_cast<const char*>(&head), sizeof(head));
-                                stream_write(*s, buf.seekg(0), p);
-                                if(auto sockfd = s->native_handle(); sockfd != s->BAD_SOCKET)
-                                    triggers().set(sockfd, POLLOUT);
-                                state_update(conn, head.type, time);
-                            }
+                for(auto& conn: connections().north(nsp)) {
+                    if(auto s = conn.south.lock()) {
+                        if(++connected && conn.state != connection_type::CLOSED){
+                            head.eid = conn.uuid;
+                            s->write(reinterpret_cast<const char*>(&head), sizeof(head));
+                            stream_write(*s, buf.seekg(0), p);
+                            CLOUDBUS_PROBE(frame_enqueue, &conn.uuid, s->native_handle(), head.len.length);
+                            if(auto sockfd = s->native_handle(); sockfd != s->BAD_SOCKET)
+                                triggers().set(sockfd, POLLOUT);
+                            auto& times = *conn.timestamps;
+                            if(times[connection_type::RESPONSE] == connection_type::time_point())
+                                times[connection_type::REQUEST] = time;
+                            state_update(conn, head.type, time, *this);
                         }
                     }
                 }
@@ -240,6 +245,7 @@ namespace cloudbus {
                             return -1;
                     } else return clear_triggers(nfd, triggers(), revents, (POLLIN | POLLHUP));
                 }
+                north_bytes() += p;
             }
             if(eof){
                 /* run state handler in-case session is closed. */
@@ -256,6 +262,7 @@ namespace cloudbus {
                 const std::streamsize pos=buf.tellp(), gpos=buf.tellg();
                 if(const auto rem=buf.len()->length-pos; !rem) {
                     const auto *eid = buf.eid();
+                    CLOUDBUS_PROBE(frame_dequeue, eid, sfd, buf.len()->length);
                     const std::streamsize seekpos =
                         (gpos <= HDRLEN)
                         ? HDRLEN
@@ -265,11 +272,8 @@ namespace cloudbus {
                         *eid, {1, sizeof(abort)},
                         {0,0},{messages::STOP, messages::ABORT}
                     };
-                    for(auto& conn: connections()) {
-                        if (
-                            !messages::uuidcmp_node(&conn.uuid, eid) &&
-                            owner_equal(conn.south, ssp)
-                        ){
+                    for(auto& conn: connections().uuid(*eid)) {
+                        if(owner_equal(conn.south, ssp)){
                             if(conn.state == connection_type::CLOSED)
                                 break;
                             if(auto n = conn.north.lock()) {
@@ -283,21 +287,27 @@ namespace cloudbus {
                                     buf.seekg(seekpos);
                                     if(!_south_write(n, buf))
                                         return clear_triggers(sfd, triggers(), revents, (POLLIN | POLLHUP));
+                                    auto& times = *conn.timestamps;
+                                    if(times[connection_type::RESPONSE] == connection_type::time_point()) {
+                                        times[connection_type::RESPONSE] = time;
+                                        if(auto *load = interface.load(ssp))
+                                            interface.record(*load, &interface_base::latency_type::ttfb, time - times[connection_type::HALF_OPEN]);
+                                    }
                                 }
                                 auto prev = conn.state;
-                                state_update(conn, *type, time);
+                                state_update(conn, *type, time, *this);
                                 if(mode() == HALF_DUPLEX &&
                                         prev == connection_type::HALF_OPEN &&
                                         conn.state != connection_type::HALF_OPEN &&
                                         seekpos == HDRLEN && pos > seekpos
                                 ){
-                                    for(auto& c: connections()){
+                                    for(auto& c: connections().uuid(*eid)){
                                         if(c.uuid == *eid && c.state < connection_type::HALF_CLOSED) {
                                             if(!owner_equal(c.south, ssp)) {
                                                 if(auto sp = c.south.lock()) {
                                                     sp->write(reinterpret_cast<const char*>(&abort), sizeof(abort));
                                                     triggers().set(sp->native_handle(), POLLOUT);
-                                                    state_update(c, abort.type, time);
+                                                    state_update(c, abort.type, time, *this);
                                                 }
                                                 Logger::getInstance().debug(
                                                     __FILE__ " -- abort connection and latch."
@@ -328,19 +338,11 @@ namespace cloudbus {
             connector::connections_type& connections
         ){
             auto&[ssp, sfd] = hnd;
-            auto begin = connections.begin(), end = connections.end();
-            auto new_end = std::remove_if(
-                    begin,
-                    end,
-                [&](auto& conn) {
-                    if(owner_equal(conn.south, ssp)) {
-                        if(sfd != ssp->BAD_SOCKET)
-                            triggers.set(sfd, POLLOUT);
-                    }
-                    return owner_equal(conn.south, ssp);
-                }
-            );
-            connections.erase(new_end, end);
+            auto range = connections.south(ssp);
+            for(auto it = range.begin(); it != range.end(); it = connections.erase(it)) {
+                if(sfd != ssp->BAD_SOCKET)
+                    triggers.set(sfd, POLLOUT);
+            }
             auto it = std::find_if(
                     nbd.streams().begin(),
                     nbd.streams().end(),
@@ -362,37 +364,24 @@ namespace cloudbus {
                 size;
         }
         static const interface_base::handle_type& select_stream(interface_base& sbd) {
-            using stream_ptr = interface_base::stream_ptr;
             static constexpr std::size_t ratio = 2;
-            const auto num_streams = sbd.streams().size();
+            const auto& streams = sbd.streams();
+            const auto& loads = sbd.loads();
+            const auto num_streams = streams.size();
             if(!num_streams)
                 return sbd.make();
-            const auto& measurements = metrics::get().streams().get_all_measurements();
-            std::size_t loaded = 0;
-            auto mbegin = measurements.cbegin(), mend = measurements.cend();
-            auto min = mbegin;
-            auto lru = sbd.streams().begin(), end=sbd.streams().end();
-            for(auto it=lru; it != end; ++it) {
-                auto&[sp, fd] = *it;
-                auto lb = std::lower_bound(
-                    mbegin,
-                    mend,
-                    sp,
-                    [](const auto& lhs, const stream_ptr& sp) {
-                        return lhs.wp.owner_before(sp);
-                    }
-                );
+            std::size_t loaded = 0, lru = 0;
+            for(std::size_t i=0; i < num_streams; ++i) {
+                const auto& load = loads[i];
                 /* return the stream if there are no associated metrics. */
-                if(lb == mend || !owner_equal(lb->wp, sp))
-                    return *it;
+                if(!load.measured)
+                    return streams[i];
                 /* count number of loaded nodes. */
-                if(lb->intercompletion > lb->interarrival/ratio)
+                if(load.intercompletion > load.interarrival/ratio)
                     ++loaded;
                 /* least recently used */
-                if(lb->last_arrival < min->last_arrival) {
-                    min = lb;
-                    lru = it;
-                }
+                if(load.last_arrival < loads[lru].last_arrival)
+                    lru = i;
             }
             if(loaded >= num_streams) {
                 /* Try and scale-out before applying LRU. It is         *
@@ -406,7 +395,7 @@ namespace cloudbus {
                 if(num_streams < rescale(sbd.addresses().size()))
                     return sbd.make();
             }
-            return *lru;
+            return streams[lru];
         }
         std::streamsize connector::_north_connect(
             north_type& interface,
@@ -418,10 +407,11 @@ namespace cloudbus {
             if(eid == messages::uuid{})
                 return -1;
             metrics::get().arrivals().fetch_add(1, std::memory_order_relaxed);
-            connections_type connect;
+            std::vector<connection_type> connect;
             for(auto& sbd: south()) {
-                auto&[sptr, sockfd] = select_stream(sbd);
-                metrics::get().streams().add_arrival(sptr);
+                auto& selected = select_stream(sbd);
+                sbd.load(selected).arrival(n);
+                auto&[sptr, sockfd] = selected;
                 if(sockfd != sptr->BAD_SOCKET) {
                     triggers().set(sockfd, POLLIN | POLLOUT);
                     sptr->clear(sptr->rdstate() & ~sptr->failbit);
@@ -449,6 +439,7 @@ namespace cloudbus {
                                 }
                                 sptr->native_handle() = set_flags(sockfd);
                                 sptr->connectto(addr, addrlen);
+                                index(hnd, sbd);
                             }
                             triggers().set(sockfd, POLLIN | POLLOUT);
                         }
@@ -471,6 +462,7 @@ namespace cloudbus {
                         connection_type::HALF_OPEN,
                     n
                 ));
+                CLOUDBUS_PROBE(session_create, &eid, nsp->native_handle(), sockfd);
             }
             const std::streamsize pos = buf.tellp();
             messages::msgheader head;
@@ -480,48 +472,41 @@ namespace cloudbus {
                 messages::msgtype{messages::STOP, messages::INIT} :
                 messages::msgtype{messages::DATA, messages::INIT};
             std::streamsize len = 0;
-            if(write_prepare(connect, nsp, pos) == connect.cend()){
+            if(!write_prepare(connect, pos)){
                 for(auto& c: connect){
                     if(auto s = c.south.lock()){
                         head.eid = c.uuid;
                         s->write(reinterpret_cast<const char*>(&head), sizeof(head));
                         stream_write(*s, buf.seekg(0), pos);
+                        c.timestamps->at(connection_type::REQUEST) = n;
+                        CLOUDBUS_PROBE(frame_enqueue, &c.uuid, s->native_handle(), head.len.length);
                     }
                 }
                 len = sizeof(head) + pos;
             }
-            connections().insert(
-                connections().end(),
-                std::make_move_iterator(connect.begin()),
-                std::make_move_iterator(connect.end())
-            );
-            shrink_to_fit(connections());
+            for(auto& c: connect)
+                connections().insert(std::move(c));
             return len;
         }
         void connector::_north_err_handler(north_type& interface, const north_type::handle_type& stream, event_mask& revents){
-            auto begin = connections().begin(), end = connections().end();
             messages::msgheader abort = {
                 {}, {1, static_cast<std::uint16_t>(sizeof(abort))},
                 {0,0}, {messages::STOP, messages::ABORT}
             };
             const auto&[nsp, nfd] = stream;
-            auto new_end = std::remove_if(
-                    begin,
-                    end,
-                [&](auto& conn) {
-                    if(owner_equal(conn.north, nsp)) {
-                        if(auto s = conn.south.lock()) {
-                            triggers().set(s->native_handle(), POLLOUT);
-                            if(conn.state < connection_type::CLOSED) {
-                                abort.eid = conn.uuid;
-                                s->write(reinterpret_cast<char*>(&abort), sizeof(abort));
-                            }
-                        }
+            auto range = connections().north(nsp);
+            for(auto it = range.begin(); it != range.end(); it = connections().erase(it)) {
+                if(auto s = it->south.lock()) {
+                    triggers().set(s->native_handle(), POLLOUT);
+                    if(it->state < connection_type::CLOSED) {
+                        interface_base::load_type *load = nullptr;
+                        if(south_load(south(), *it, load))
+                            load->abandon();
+                        abort.eid = it->uuid;
+                        s->write(reinterpret_cast<char*>(&abort), sizeof(abort));
                     }
-                    return owner_equal(conn.north, nsp);
                 }
-            );
-            connections().erase(new_end, end);
+            }
             revents = 0;
             triggers().clear(nfd);
             interface.erase(stream);
@@ -533,13 +518,13 @@ namespace cloudbus {
             return route(*it->pbuf, interface, stream, revents);
         }
         int connector::_north_accept_handler(north_type& interface, const north_type::handle_type& stream, event_mask& revents){
-            using native_handle_type = north_type::native_handle_type;
             if(drain())
                 return -1;
             int sockfd = -1;
-            auto listenfd = std::get<native_handle_type>(stream);
-            while( (sockfd = _accept(listenfd, nullptr, nullptr)) > -1) {
-                interface.make(sockfd, true);
+            const auto& lsp = std::get<north_type::stream_ptr>(stream);
+            while( (sockfd = _accept(lsp)) > -1) {
+                CLOUDBUS_PROBE(accept, sockfd);
+                index(interface.make(sockfd, true), interface);
                 if(interface.protocol() == "TCP") {
                     static constexpr int nodelay = 1;
                     if(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)))
@@ -553,13 +538,11 @@ namespace cloudbus {
         static auto session_state(const connector::connections_type& connections, const connector::north_type::stream_ptr& nsp){
             using connection = connector::connection_type;
             short state = connection::CLOSED;
-            for(const auto& c: connections) {
-                if(owner_equal(c.north, nsp)) {
-                    if(c.state == connection::OPEN) {
-                        state = c.state;
-                    } else if (state != connection::OPEN) {
-                        state = std::min(state, c.state);
-                    }
+            for(const auto& c: connections.north(nsp)) {
+                if(c.state == connection::OPEN) {
+                    state = c.state;
+                } else if (state != connection::OPEN) {
+                    state = std::min(state, c.state);
                 }
             }
             return state;
@@ -571,12 +554,13 @@ namespace cloudbus {
                     return _north_err_handler(interface, stream, revents);
                 case connection_type::HALF_CLOSED:
                     revents |= POLLHUP;
-                    shutdown(nfd, SHUT_WR);
+                    nsp->shutdown(SHUT_WR);
                 default: break;
             }
         }
         int connector::_north_pollout_handler(const north_type::handle_type& stream, event_mask& revents){
             const auto&[nsp, nfd] = stream;
+            reap_zerocopy(nsp, nfd, revents);
             if(revents & POLLERR)
             {
                 int ec = 0; socklen_t len = sizeof(ec);
@@ -584,10 +568,11 @@ namespace cloudbus {
                     throw_system_error("Unable to get SO_ERROR.");
                 if(ec)
                     nsp->err() = ec;
-                Logger::getInstance().error(
-                    "northbound socket stream error: " +
-                    std::system_category().message(nsp->err())
-                );
+                static thread_local Logger::rate_limit limit;
+                Logger::getInstance().log(Logger::Level::ERROR, limit, nsp->err(), [&](){
+                    return "northbound socket stream error: " +
+                        std::system_category().message(nsp->err());
+                });
             }
             if(revents & (POLLERR | POLLNVAL))
                 nsp->setstate(nsp->badbit);
@@ -602,6 +587,7 @@ namespace cloudbus {
             size_type handled = 0;
             if(revents & (POLLOUT | POLLERR | POLLNVAL)){
                 ++handled;
+                loop_metrics::timer timer(loop_metrics::NORTH_POLLOUT);
                 if(_north_pollout_handler(stream, revents)) {
                     _north_err_handler(interface, stream, revents);
                 } else {
@@ -611,9 +597,11 @@ namespace cloudbus {
             if(revents & (POLLIN | POLLHUP)){
                 ++handled;
                 if(stream == interface.streams().front()) {
+                    loop_metrics::timer timer(loop_metrics::NORTH_ACCEPT);
                     if(_north_accept_handler(interface, stream, revents))
                         _north_err_handler(interface, stream, revents);
                 } else {
+                    loop_metrics::timer timer(loop_metrics::NORTH_POLLIN);
                     if(_north_pollin_handler(interface, stream, revents))
                         _north_err_handler(interface, stream, revents);
                 }
@@ -641,23 +629,14 @@ namespace cloudbus {
         void connector::_south_err_handler(south_type& interface, const south_type::handle_type& stream, event_mask& revents){
             const auto&[ssp, sfd] = stream;
             const auto time = connection_type::clock_type::now();
-            auto begin = connections().begin(), end = connections().end();
-            auto new_end = std::remove_if(
-                    begin,
-                    end,
-                [&](auto& conn) {
-                    if(owner_equal(conn.south, ssp)) {
-                        if(auto n = conn.north.lock())
-                        {
-                            state_update(conn, {messages::STOP, messages::ABORT}, time);
-                            triggers().set(n->native_handle(), POLLOUT);
-                        }
-                        else return true;
-                    }
-                    return false;
-                }
-            );
-            connections().erase(new_end, end);
+            auto range = connections().south(ssp);
+            for(auto it = range.begin(); it != range.end(); ) {
+                if(auto n = it->north.lock()) {
+                    state_update(*it, {messages::STOP, messages::ABORT}, time, *this);
+                    triggers().set(n->native_handle(), POLLOUT);
+                    ++it;
+                } else it = connections().erase(it);
+            }
             revents = 0;
             triggers().clear(sfd);
             switch(ssp->err()) {
@@ -666,6 +645,7 @@ namespace cloudbus {
                 default:
                     break;
             }
+            timeouts().cancel(ssp);
             interface.erase(stream);
         }
         std::streamsize connector::_south_write(const north_type::stream_ptr& n, marshaller_type::south_format& buf){
@@ -677,24 +657,29 @@ namespace cloudbus {
             if(n->tellp() < pos){
                 if(stream_write(*n, buf).bad())
                     return -1;
+                south_bytes() += p-g;
                 return p-g;
             } else return 0;
         }
         int connector::_south_pollin_handler(south_type& interface, const south_type::handle_type& stream, event_mask& revents){
-            if(auto it = marshaller().marshal(stream); it != marshaller().south().end()){
+            /* route every complete frame that one receive has buffered. */
+            std::size_t batch = 0;
+            do {
+                auto it = marshaller().marshal(stream);
+                if(it == marshaller().south().end())
+                    return -1;
                 if(std::get<south_type::stream_ptr>(stream)->gcount() == 0)
                     revents &= ~(POLLIN | POLLHUP);
-                return route(*it->pbuf, interface, stream, revents);
-            } else return -1;
+                if(int rc = route(*it->pbuf, interface, stream, revents))
+                    return rc;
+            } while( (revents & POLLIN) && ++batch < MAX_BATCH );
+            return 0;
         }
         int connector::_south_state_handler(const south_type::handle_type& stream){
             const auto&[ssp, sfd] = stream;
-            for(const auto& conn: connections()) {
-                if(owner_equal(conn.south, ssp) &&
-                    conn.state < connection_type::CLOSED
-                ){
+            for(const auto& conn: connections().south(ssp)) {
+                if(conn.state < connection_type::CLOSED)
                     return 0;
-                }
             }
             using milliseconds = std::chrono::milliseconds;
             using weak_ptr = std::weak_ptr<south_type::stream_type>;
@@ -704,16 +689,15 @@ namespace cloudbus {
                 clock_type::now()+milliseconds(30000),
                 [&, wp=weak_ptr(ssp)]() {
                     if(!wp.expired()) {
-                        auto begin = connections().begin(), end = connections().end();
+                        auto range = connections().south(wp);
                         auto it = std::find_if(
-                            begin,
-                            end,
+                            range.begin(),
+                            range.end(),
                             [&](const auto& conn) {
-                                return owner_equal(conn.south, wp) &&
-                                    conn.state < connection_type::CLOSED;
+                                return conn.state < connection_type::CLOSED;
                             }
                         );
-                        if(it == end) {
+                        if(it == range.end()) {
                             if(auto sp = wp.lock()) {
                                 sp->setstate(sp->failbit);
                                 triggers().set(sp->native_handle(), POLLOUT);
@@ -726,6 +710,7 @@ namespace cloudbus {
         }
         int connector::_south_pollout_handler(const south_type::handle_type& stream, event_mask& revents){
             const auto&[ssp, sfd] = stream;
+            reap_zerocopy(ssp, sfd, revents);
             if(revents & POLLERR)
             {
                 int ec = 0; socklen_t len = sizeof(ec);
@@ -733,17 +718,20 @@ namespace cloudbus {
                     throw_system_error("Unable to get SO_ERROR.");
                 if(ec)
                     ssp->err() = ec;
-                Logger::getInstance().error(
-                    "southbound socket stream error: " +
-                    std::system_category().message(ssp->err())
-                );
+                static thread_local Logger::rate_limit limit;
+                Logger::getInstance().log(Logger::Level::ERROR, limit, ssp->err(), [&](){
+                    return "southbound socket stream error: " +
+                        std::system_category().message(ssp->err());
+                });
             }
             if(revents & (POLLERR | POLLNVAL))
                 ssp->setstate(ssp->badbit);
             if(ssp->flush().fail())
                 return -1;
-            if(ssp->tellp() == 0)
+            if(ssp->tellp() == 0) {
                 triggers().clear(sfd, POLLOUT);
+                sent(ssp);
+            }
             revents &= ~(POLLOUT | POLLERR | POLLNVAL);
             return 0;
         }
@@ -751,6 +739,7 @@ namespace cloudbus {
             size_type handled = 0;
             if( (revents & (POLLOUT | POLLERR | POLLNVAL)) && ++handled )
             {
+                loop_metrics::timer timer(loop_metrics::SOUTH_POLLOUT);
                 if(_south_pollout_handler(stream, revents))
                     _south_err_handler(interface, stream, revents);
                 else if(_south_state_handler(stream))
@@ -758,6 +747,7 @@ namespace cloudbus {
             }
             if( (revents & (POLLIN | POLLHUP)) && ++handled)
             {
+                loop_metrics::timer timer(loop_metrics::SOUTH_POLLIN);
                 if(_south_pollin_handler(interface, stream, revents))
                     _south_err_handler(interface, stream, revents);
             }
@@ -62,7 +62,9 @@ namespace cloudbus{
             std::streamsize maxlen = UINT16_MAX - hdrlen;
             while(auto gcount = is.readsome(_buf.data(), std::min(maxlen, static_cast<std::streamsize>(_buf.max_size())))){
                 os.write(_buf.data(), gcount);
-                maxlen -= gcount;
+                /* stop on a full frame so gcount() still reports buffered data. */
+                if(!(maxlen -= gcount))
+                    break;
             }
             return is.eof();
         }
@@ -15,6 +15,7 @@
 */
 #include "../../logging.hpp"
 #include "../../metrics.hpp"
+#include "../../trace.hpp"
 #include "segment_connector.hpp"
 #include <sys/un.h>
 #include <unistd.h>
@@ -24,29 +25,27 @@
 namespace cloudbus{
     namespace segment {
         static constexpr std::streamsize MAX_BUFSIZE = 65536 * 4096; /* 256MiB */
+        static constexpr std::size_t MAX_BATCH = 64; /* frames per readiness event. */
         namespace {
-            template<class T>
-            static bool shrink_to_fit(std::vector<T>& vec){
-                static constexpr std::size_t THRESH = 256;
-                bool resized = false;
-                const std::size_t capacity = vec.capacity();
-                if( capacity > THRESH &&
-                    vec.size() < capacity/8
-                ){
-                    vec  = std::vector<T>(
-                        std::make_move_iterator(vec.begin()),
-                        std::make_move_iterator(vec.end())
-                    );
-                    resized = true;
-                }
-                return resized;
-            }
             static void throw_system_error(const std::string& what) {
                 throw std::system_error(
                     std::error_code(errno, std::system_category()),
                     what
                 );
             }
+            /* MSG_ZEROCOPY completions are queued on the error *
+             * queue, they raise POLLERR but aren't errors.     */
+            template<class StreamPtr>
+            static void reap_zerocopy(const StreamPtr& sp, int sockfd, short& revents){
+                if(!(revents & POLLERR) || sp->reap() < 1)
+                    return;
+                int ec = 0; socklen_t len = sizeof(ec);
+                if(getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &ec, &len))
+                    throw_system_error("Unable to get SO_ERROR.");
+                if(ec)
+                    sp->err() = ec;
+                else revents &= ~POLLERR;
+            }
             static int set_flags(int fd){
                 int flags = 0;
                 if(fcntl(fd, F_SETFD, FD_CLOEXEC))
@@ -57,24 +56,28 @@ namespace cloudbus{
                     throw_system_error("Unable to set O_NONBLOCK.");
                 return fd;
             }
-            static int _accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen){
+            /* accepted sockets are already non-blocking and close-on-exec. */
+            template<class StreamPtr>
+            static int _accept(const StreamPtr& sp){
                 int fd = -1;
-                while( (fd = accept(sockfd, addr, addrlen)) < 0 ){
+                while( (fd = sp->accept()) < 0 ){
                     switch(errno){
                         case EINTR:
                             continue;
                         default:
-                            return -errno;                    
+                            return -errno;
                     }
                 }
-                return set_flags(fd);
+                return fd;
             }
             static void state_update(
                 connector::connection_type& conn,
                 const messages::msgtype& type,
-                const connector::connection_type::time_point time
+                const connector::connection_type::time_point time,
+                connector& c
             ){
                 using connection_type = connector::connection_type;
+                auto prev = conn.state;
                 switch(conn.state){
                     case connection_type::HALF_OPEN:
                         conn.timestamps->at(++conn.state) = time;
@@ -88,6 +91,11 @@ namespace cloudbus{
                     default:
                         break;
                 }
+                if(conn.state == prev)
+                    return;
+                CLOUDBUS_PROBE(session_state, &conn.uuid, prev, conn.state);
+                if(conn.state == connection_type::CLOSED)
+                    c.complete(conn);
             }
             static std::ostream& stream_write(std::ostream& os, std::istream& is){
                 std::array<char, 256> buf;
@@ -109,6 +117,43 @@ namespace cloudbus{
                 }
                 return os;
             }
+            struct splice_pipe {
+                std::array<int, 2> fds;
+                splice_pipe(): fds{-1, -1} {
+                    if(pipe2(fds.data(), O_NONBLOCK | O_CLOEXEC))
+                        throw_system_error("Unable to open splice pipe.");
+                }
+                ~splice_pipe() {
+                    close(fds[0]);
+                    close(fds[1]);
+                }
+            };
+            /* Moves len bytes out of the pipe and into sockfd, whatever *
+             * the socket won't take is copied into os instead so the    *
+             * pipe is always left empty.                                */
+            static std::ostream& pipe_write(std::ostream& os, int sockfd, int pipefd, std::size_t len, bool direct){
+                while(direct && len) {
+                    auto n = splice(pipefd, nullptr, sockfd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                    if(n > 0)
+                        len -= n;
+                    else if(n < 0 && errno == EINTR)
+                        continue;
+                    else break;
+                }
+                std::array<char, 4096> buf;
+                while(len) {
+                    auto n = read(pipefd, buf.data(), std::min(len, buf.size()));
+                    if(n < 0 && errno == EINTR)
+                        continue;
+                    if(n <= 0) {
+                        os.setstate(os.badbit);
+                        return os;
+                    }
+                    os.write(buf.data(), n);
+                    len -= n;
+                }
+                return os;
+            }
             static int clear_triggers(
                 int sockfd,
                 connector::trigger_type& triggers,
@@ -123,58 +168,59 @@ namespace cloudbus{
         connector::connector(
             trigger_type& triggers,
             const config::section& section
-        ): Base(triggers, section) {}  
+        ):
+            Base(triggers, section),
+            /* Splicing would overtake the sends that are queued on *
+             * io_uring, so io_uring copies through the sockbufs.    */
+            _passthrough{passthrough(section) && triggers.backend() != trigger_type::URING}
+        {}
+        bool connector::passthrough(const config::section& section) {
+            bool on = false;
+            for(const auto&[key, value]: section) {
+                std::string k = key, v = value;
+                std::transform(k.begin(), k.end(), k.begin(), [](const unsigned char c){ return std::toupper(c); });
+                if(k != "PASSTHROUGH")
+                    continue;
+                std::transform(v.begin(), v.end(), v.begin(), [](const unsigned char c){ return std::toupper(c); });
+                if(v == "ON")
+                    on = true;
+                else if(v == "OFF")
+                    on = false;
+                else throw std::invalid_argument("Invalid passthrough: " + value);
+            }
+            return on;
+        }  
         connector::size_type connector::_handle(events_type& events){
             size_type handled = 0;
             auto end = std::remove_if(
                     events.begin(), events.end(),
                 [&](auto& ev) {
+                    interface_type *interface = nullptr;
+                    interface_base::handle_type hnd;
                     if(ev.revents) {
-                        auto nit = std::find_if(
-                                north().begin(),
-                                north().end(),
-                            [&](auto& interface){
-                                auto it = std::find_if(
-                                        interface.streams().cbegin(),
-                                        interface.streams().cend(),
-                                    [&](const auto& stream){
-                                        const auto&[nsp, sockfd] = stream;
-                                        if(sockfd == ev.fd && ev.revents & (POLLOUT | POLLERR))
-                                            for(auto& c: connections())
-                                                if(owner_equal(c.north, nsp))
-                                                    if(auto s = c.south.lock(); s && !s->eof())
-                                                        triggers().set(s->native_handle(), POLLIN);
-                                        return sockfd == ev.fd;
-                                    }
-                                );
-                                if(it != interface.streams().cend())
-                                    handled += _handle(static_cast<north_type&>(interface), *it, ev.revents);
-                                return it != interface.streams().cend();
+                        switch(lookup(ev.fd, interface, hnd)) {
+                            case NORTH:
+                            {
+                                const auto& nsp = std::get<north_type::stream_ptr>(hnd);
+                                if(ev.revents & (POLLOUT | POLLERR))
+                                    for(auto& c: connections().north(nsp))
+                                        if(auto s = c.south.lock(); s && !s->eof())
+                                            triggers().set(s->native_handle(), POLLIN);
+                                handled += _handle(static_cast<north_type&>(*interface), hnd, ev.revents);
+                                break;
                             }
-                        );
-                        if(nit == north().end()){
-                            std::find_if(
-                                    south().begin(),
-                                    south().end(),
-                                [&](auto& interface){
-                                    auto it = std::find_if(
-                                            interface.streams().cbegin(),
-                                            interface.streams().cend(),
-                                        [&](const auto& stream){
-                                            const auto&[ssp, sockfd] = stream;
-                                            if(sockfd==ev.fd && ev.revents & (POLLOUT | POLLERR))
-                                                for(auto& c: connections())
-                                                    if(owner_equal(c.south, ssp))
-                                                        if(auto n = c.north.lock(); n && !n->eof())
-                                                            triggers().set(n->native_handle(), POLLIN);
-                                            return sockfd == ev.fd;
-                                        }
-                                    );
-                                    if(it != interface.streams().cend())
-                                        handled += _handle(static_cast<south_type&>(interface), *it, ev.revents);
-                                    return it != interface.streams().cend();
-                                }
-                            );
+                            case SOUTH:
+                            {
+                                const auto& ssp = std::get<south_type::stream_ptr>(hnd);
+                                if(ev.revents & (POLLOUT | POLLERR))
+                                    for(auto& c: connections().south(ssp))
+                                        if(auto n = c.north.lock(); n && !n->eof())
+                                            triggers().set(n->native_handle(), POLLIN);
+                                handled += _handle(static_cast<south_type&>(*interface), hnd, ev.revents);
+                                break;
+                            }
+                            default:
+                                break;
                         }
                     }
                     return !ev.revents;
@@ -191,12 +237,13 @@ namespace cloudbus{
                 const std::streamsize pos=buf.tellp(), gpos=buf.tellg();
                 if(const auto rem=buf.len()->length-pos; !rem) {
                     const auto *eid = buf.eid();
+                    CLOUDBUS_PROBE(frame_dequeue, eid, nfd, buf.len()->length);
                     const std::streamsize seekpos =
                         (gpos <= HDRLEN)
                             ? HDRLEN
                             : gpos;
                     const auto time = connection_type::clock_type::now();
-                    for(auto& conn: connections()) {
+                    for(auto& conn: connections().uuid(*eid)) {
                         if(conn.uuid == *eid && owner_equal(conn.north, nsp)) {
                             if(conn.state == connection_type::CLOSED)
                                 break;
@@ -208,11 +255,14 @@ namespace cloudbus{
                                     buf.seekg(seekpos);
                                     if(!_north_write(s, buf))
                                         return clear_triggers(nfd, triggers(), revents, (POLLIN | POLLHUP));
+                                    auto& times = *conn.timestamps;
+                                    if(times[connection_type::RESPONSE] == connection_type::time_point())
+                                        times[connection_type::REQUEST] = time;
                                 }
                                 if(type->flags & messages::ABORT)
                                     s->setstate(s->badbit); 
                             }
-                            state_update(conn, *type, time);
+                            state_update(conn, *type, time, *this);
                             buf.setstate(buf.eofbit);
                             return eof ? -1 : 0;
                         }
@@ -247,23 +297,25 @@ namespace cloudbus{
             auto&[ssp, sfd] = stream;
             const auto p = buf.tellp();
             const auto eof = ssp->eof();
-            for(auto& conn: connections()) {
-                if( owner_equal(conn.south, ssp) ) {
-                    if(auto n = conn.north.lock()) {
-                        messages::msgtype t = {messages::DATA, 0};
-                        if(eof)
-                            t.op = messages::STOP;
-                        if(eof || p) {
-                            buf.seekg(0);
-                            triggers().set(n->native_handle(), POLLOUT);
-                            if(!_south_write(n, conn, buf))
-                                return clear_triggers(sfd, triggers(), revents, (POLLIN | POLLHUP));
-                        }
-                        state_update(conn, t, clock_type::now());
-                        if(eof)
-                            triggers().clear(sfd, POLLIN);
-                        return conn.state == conn.CLOSED ? -1 : 0;
+            for(auto& conn: connections().south(ssp)) {
+                if(auto n = conn.north.lock()) {
+                    messages::msgtype t = {messages::DATA, 0};
+                    if(eof)
+                        t.op = messages::STOP;
+                    if(eof || p) {
+                        buf.seekg(0);
+                        triggers().set(n->native_handle(), POLLOUT);
+                        if(!_south_write(n, conn, buf))
+                            return clear_triggers(sfd, triggers(), revents, (POLLIN | POLLHUP));
                     }
+                    const auto time = clock_type::now();
+                    auto& response = conn.timestamps->at(connection_type::RESPONSE);
+                    if(p && response == connection_type::time_point())
+                        response = time;
+                    state_update(conn, t, time, *this);
+                    if(eof)
+                        triggers().clear(sfd, POLLIN);
+                    return conn.state == conn.CLOSED ? -1 : 0;
                 }
             }
             return p ? -1 : 0;
@@ -280,19 +332,12 @@ namespace cloudbus{
                 {0,0}, {messages::STOP, messages::ABORT}
             };
             auto&[ssp, sfd] = hnd;
-            auto end = std::remove_if(
-                    connections.begin(),
-                    connections.end(),
-                [&](auto& conn) {
-                    if(owner_equal(conn.south, ssp)) {
-                        abort.eid = conn.uuid;
-                        nsp->write(reinterpret_cast<char*>(&abort), sizeof(abort));
-                        triggers.set(nsp->native_handle(), POLLOUT);
-                    }
-                    return owner_equal(conn.south, ssp);
-                }
-            );
-            connections.erase(end, connections.end());
+            auto range = connections.south(ssp);
+            for(auto it = range.begin(); it != range.end(); it = connections.erase(it)) {
+                abort.eid = it->uuid;
+                nsp->write(reinterpret_cast<char*>(&abort), sizeof(abort));
+                triggers.set(nsp->native_handle(), POLLOUT);
+            }
             return (void)sbd.erase(hnd);
         }
         std::streamsize connector::_north_connect(north_type& interface, const north_type::stream_ptr& nsp, marshaller_type::north_format& buf){
@@ -322,6 +367,7 @@ namespace cloudbus{
                         }
                         sptr->native_handle() = set_flags(sockfd);
                         sptr->connectto(addr, addrlen);
+                        index(hnd, sbd);
                     }
                     triggers().set(sockfd, POLLIN | POLLOUT);
                 }
@@ -329,7 +375,7 @@ namespace cloudbus{
             /* Address resolution only on the first pending connect. */
             if(sbd.addresses().empty() && sbd.npending()==1)
                 resolver().resolve(sbd);
-            connections().push_back(
+            auto conn = connections().insert(
                 connection_type::make(
                     *buf.eid(),
                     nsp,
@@ -339,28 +385,22 @@ namespace cloudbus{
                         connection_type::HALF_OPEN
                 )
             );
-            shrink_to_fit(connections());
+            auto& times = *conn->timestamps;
+            times[connection_type::REQUEST] = times[connection_type::HALF_OPEN];
+            CLOUDBUS_PROBE(session_create, &conn->uuid, nsp->native_handle(), ssp->native_handle());
             return _north_write(ssp, buf);
         }
         void connector::_north_err_handler(north_type& interface, const north_type::handle_type& stream, event_mask& revents){
             const auto time = connection_type::clock_type::now();
             const auto&[nsp, nfd] = stream;
-            auto end = std::remove_if(
-                    connections().begin(),
-                    connections().end(),
-                [&](auto& conn) {
-                    if(owner_equal(conn.north, nsp)) {
-                        if(auto s = conn.south.lock())
-                        {
-                            state_update(conn, {messages::STOP, messages::ABORT}, time);
-                            triggers().set(s->native_handle(), POLLOUT);
-                        }
-                        else return true;
-                    }
-                    return false;
-                }
-            );
-            connections().erase(end, connections().end());
+            auto range = connections().north(nsp);
+            for(auto it = range.begin(); it != range.end(); ) {
+                if(auto s = it->south.lock()) {
+                    state_update(*it, {messages::STOP, messages::ABORT}, time, *this);
+                    triggers().set(s->native_handle(), POLLOUT);
+                    ++it;
+                } else it = connections().erase(it);
+            }
             revents = 0;
             triggers().clear(nfd);
             interface.erase(stream);
@@ -373,24 +413,33 @@ namespace cloudbus{
             if(s->tellp() < pos){
                 if(stream_write(*s, buf).bad())
                     return -1;
+                north_bytes() += p-g;
                 return p-g;
             } else return 0;
         }
         int connector::_north_pollin_handler(north_type& interface, const north_type::handle_type& stream, event_mask& revents){
-            if(auto it = marshaller().unmarshal(stream); it != marshaller().north().end()){
-                using stream_ptr = north_type::stream_ptr;
+            using stream_ptr = north_type::stream_ptr;
+            /* route every complete frame that one receive has buffered. */
+            std::size_t batch = 0;
+            do {
+                auto it = marshaller().unmarshal(stream);
+                if(it == marshaller().north().end())
+                    return -1;
                 if(!std::get<stream_ptr>(stream)->gcount())
                     revents &= ~(POLLIN | POLLHUP);
-                return route(*it->pbuf, interface, stream, revents);
-            } else return -1;
+                if(int rc = route(*it->pbuf, interface, stream, revents))
+                    return rc;
+            } while( (revents & POLLIN) && ++batch < MAX_BATCH );
+            return 0;
         }
         int connector::_north_accept_handler(north_type& interface, const north_type::handle_type& stream, event_mask& revents){
-            using native_handle_type = north_type::native_handle_type;
             if(drain())
                 return -1;
-            int sockfd = -1, listenfd = std::get<native_handle_type>(stream);
-            while( (sockfd = _accept(listenfd, nullptr, nullptr)) > -1 ){
-                interface.make(sockfd, true);
+            int sockfd = -1;
+            const auto& lsp = std::get<north_type::stream_ptr>(stream);
+            while( (sockfd = _accept(lsp)) > -1 ){
+                CLOUDBUS_PROBE(accept, sockfd);
+                index(interface.make(sockfd, true), interface);
                 if(interface.protocol() == "TCP") {
                     static constexpr int nodelay = 1;
                     if(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)))
@@ -403,6 +452,7 @@ namespace cloudbus{
         }
         int connector::_north_pollout_handler(const north_type::handle_type& stream, event_mask& revents){
             auto&[nsp, nfd] = stream;
+            reap_zerocopy(nsp, nfd, revents);
             if(revents & POLLERR)
             {
                 int ec = 0; socklen_t len = sizeof(ec);
@@ -410,10 +460,11 @@ namespace cloudbus{
                     throw_system_error("Unable to get SO_ERROR.");
                 if(ec)
                     nsp->err() = ec;
-                Logger::getInstance().error(
-                    "northbound socket stream error: " +
-                    std::system_category().message(nsp->err())
-                );
+                static thread_local Logger::rate_limit limit;
+                Logger::getInstance().log(Logger::Level::ERROR, limit, nsp->err(), [&](){
+                    return "northbound socket stream error: " +
+                        std::system_category().message(nsp->err());
+                });
             }
             if(revents & (POLLERR | POLLNVAL))
                 nsp->setstate(nsp->badbit);
@@ -428,14 +479,17 @@ namespace cloudbus{
             size_type handled = 0;
             if( (revents & (POLLOUT | POLLERR | POLLNVAL)) && ++handled )
             {
+                loop_metrics::timer timer(loop_metrics::NORTH_POLLOUT);
                 if(_north_pollout_handler(stream, revents))
                     _north_err_handler(interface, stream, revents);
             }
             if( (revents & (POLLIN | POLLHUP)) && ++handled ){
                 if(stream == interface.streams().front()) {
+                    loop_metrics::timer timer(loop_metrics::NORTH_ACCEPT);
                     if(_north_accept_handler(interface, stream, revents))
                         _north_err_handler(interface, stream, revents);
                 } else {
+                    loop_metrics::timer timer(loop_metrics::NORTH_POLLIN);
                     if(_north_pollin_handler(interface, stream, revents))
                         _north_err_handler(interface, stream, revents);
                 }
@@ -465,23 +519,16 @@ namespace cloudbus{
                 {}, {1, sizeof(abort)},
                 {0,0}, {messages::STOP, messages::ABORT}
             };            
-            auto end = std::remove_if(
-                    connections().begin(),
-                    connections().end(),
-                [&](auto& conn) {
-                    if(owner_equal(conn.south, ssp)) {
-                        if(auto n = conn.north.lock()) {
-                            if(conn.state < connection_type::CLOSED) {
-                                abort.eid = conn.uuid;
-                                n->write(reinterpret_cast<char*>(&abort), sizeof(abort));
-                                triggers().set(n->native_handle(), POLLOUT);
-                            }
-                        }
+            auto range = connections().south(ssp);
+            for(auto it = range.begin(); it != range.end(); it = connections().erase(it)) {
+                if(auto n = it->north.lock()) {
+                    if(it->state < connection_type::CLOSED) {
+                        abort.eid = it->uuid;
+                        n->write(reinterpret_cast<char*>(&abort), sizeof(abort));
+                        triggers().set(n->native_handle(), POLLOUT);
                     }
-                    return owner_equal(conn.south, ssp);
                 }
-            );
-            connections().erase(end, connections().end());
+            }
             revents = 0;
             triggers().clear(sfd);
             switch(ssp->err()) {
@@ -510,9 +557,70 @@ namespace cloudbus{
                 return -1;
             if(stream_write(*n, buf, p).bad())
                 return -1;
+            CLOUDBUS_PROBE(frame_enqueue, &conn.uuid, n->native_handle(), head.len.length);
+            south_bytes() += p;
             return size;
         }
+        int connector::_south_splice(const south_type::handle_type& stream, event_mask& revents){
+            constexpr std::size_t HDRLEN = sizeof(messages::msgheader), MAXLEN = UINT16_MAX - HDRLEN;
+            static thread_local splice_pipe pipe;
+            const auto&[ssp, sfd] = stream;
+            /* anything already buffered in user space goes first. */
+            if(ssp->eof() || ssp->buffered())
+                return 1;
+            auto& buffers = marshaller().south();
+            auto lb = std::lower_bound(
+                    buffers.begin(),
+                    buffers.end(),
+                    ssp,
+                [](const auto& lhs, const south_type::stream_ptr& ssp) {
+                    return lhs.ptr.owner_before(ssp);
+                }
+            );
+            if(lb != buffers.end() && owner_equal(lb->ptr, ssp) && lb->pbuf->tellg() != lb->pbuf->tellp())
+                return 1;
+            auto sessions = connections().south(ssp);
+            if(sessions.empty())
+                return 1;
+            auto conn = sessions.begin();
+            auto n = conn->north.lock();
+            if(!n || !n->good() || n->tellp() != 0)
+                return 1;
+            ssize_t len = 0;
+            while( (len = splice(sfd, nullptr, pipe.fds[1], nullptr, MAXLEN, SPLICE_F_MOVE | SPLICE_F_NONBLOCK)) < 0 &&
+                errno == EINTR
+            );
+            if(len < 0 && errno == EAGAIN) {
+                revents &= ~(POLLIN | POLLHUP);
+                return 0;
+            }
+            /* end-of-file and errors are reported by the copy path. */
+            if(len <= 0)
+                return 1;
+            const messages::msgheader head = {
+                conn->uuid,
+                {1, static_cast<std::uint16_t>(HDRLEN + len)},
+                {0,0},
+                {messages::DATA, 0}
+            };
+            n->write(reinterpret_cast<const char*>(&head), sizeof(head)).flush();
+            const auto nfd = n->native_handle();
+            pipe_write(*n, nfd, pipe.fds[0], len, n->good() && n->tellp() == 0);
+            CLOUDBUS_PROBE(frame_enqueue, &conn->uuid, nfd, head.len.length);
+            south_bytes() += len;
+            if(n->good() && n->tellp() != 0)
+                triggers().set(nfd, POLLOUT);
+            const auto time = connection_type::clock_type::now();
+            auto& response = conn->timestamps->at(connection_type::RESPONSE);
+            if(response == connection_type::time_point())
+                response = time;
+            state_update(*conn, head.type, time, *this);
+            return 0;
+        }
         int connector::_south_pollin_handler(south_type& interface, const south_type::handle_type& stream, event_mask& revents){
+            if(_passthrough)
+                if(int rc = _south_splice(stream, revents); rc <= 0)
+                    return rc;
             if(auto it = marshaller().marshal(stream); it != marshaller().south().end()){
                 using stream_ptr = south_type::stream_ptr;
                 if(!std::get<stream_ptr>(stream)->gcount())
@@ -522,22 +630,21 @@ namespace cloudbus{
         }
         void connector::_south_state_handler(south_type& interface, const south_type::handle_type& stream, event_mask& revents){
             const auto&[ssp, sfd] = stream;
-            for(auto& conn: connections()) {
-                if(owner_equal(conn.south, ssp)) {
-                    switch(conn.state) {
-                        case connection_type::CLOSED:
-                            return _south_err_handler(interface, stream, revents);
-                        case connection_type::HALF_CLOSED:
-                            revents |= POLLHUP;
-                            shutdown(sfd, SHUT_WR);
-                        default:
-                            return;
-                    }
+            for(auto& conn: connections().south(ssp)) {
+                switch(conn.state) {
+                    case connection_type::CLOSED:
+                        return _south_err_handler(interface, stream, revents);
+                    case connection_type::HALF_CLOSED:
+                        revents |= POLLHUP;
+                        ssp->shutdown(SHUT_WR);
+                    default:
+                        return;
                 }
             }
         }
         int connector::_south_pollout_handler(const south_type::handle_type& stream, event_mask& revents){
             auto&[ssp, sfd] = stream;
+            reap_zerocopy(ssp, sfd, revents);
             if(revents & POLLERR)
             {
                 int ec = 0; socklen_t len = sizeof(ec);
@@ -545,28 +652,33 @@ namespace cloudbus{
                     throw_system_error("Unable to get SO_ERROR.");
                 if(ec)
                     ssp->err() = ec;
-                Logger::getInstance().error(
-                    "southbound socket stream error: " +
-                    std::system_category().message(ssp->err())
-                );
+                static thread_local Logger::rate_limit limit;
+                Logger::getInstance().log(Logger::Level::ERROR, limit, ssp->err(), [&](){
+                    return "southbound socket stream error: " +
+                        std::system_category().message(ssp->err());
+                });
             }
             if(revents & (POLLERR | POLLNVAL))
                 ssp->setstate(ssp->badbit);
             if(ssp->flush().fail())
                 return -1;
-            if(ssp->tellp() == 0)
+            if(ssp->tellp() == 0) {
                 triggers().clear(sfd, POLLOUT);
+                sent(ssp);
+            }
             revents &= ~(POLLOUT | POLLERR | POLLNVAL);
             return 0;
         }
         connector::size_type connector::_handle(south_type& interface, const south_type::handle_type& stream, event_mask& revents){
             size_type handled = 0;
             if( (revents & (POLLOUT | POLLERR | POLLNVAL)) && ++handled ) {
+                loop_metrics::timer timer(loop_metrics::SOUTH_POLLOUT);
                 if(_south_pollout_handler(stream, revents))
                     _south_err_handler(interface, stream, revents);
                 else _south_state_handler(interface, stream, revents);
             }
             if( (revents & (POLLIN | POLLHUP)) && ++handled ) {
+                loop_metrics::timer timer(loop_metrics::SOUTH_POLLIN);
                 if(_south_pollin_handler(interface, stream, revents))
                     _south_err_handler(interface, stream, revents);
             }
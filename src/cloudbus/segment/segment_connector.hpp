@@ -25,6 +25,7 @@ namespace cloudbus {
             public:
                 using Base = basic_connector<segment::marshaller, handler_type>;
                 connector(trigger_type& triggers, const config::section& section);
+                static bool passthrough(const config::section& section);
                 ~connector() = default;
 
                 connector() = delete;
@@ -50,9 +51,12 @@ namespace cloudbus {
                 void _south_err_handler(south_type& interface, const south_type::handle_type& stream, event_mask& revents);
                 std::streamsize _south_write(const north_type::stream_ptr& n, const connection_type& conn, marshaller_type::south_format& buf);
                 int _south_pollin_handler(south_type& interface, const south_type::handle_type& stream, event_mask& revents);
+                int _south_splice(const south_type::handle_type& stream, event_mask& revents);
                 void _south_state_handler(south_type& interface, const south_type::handle_type& stream, event_mask& revents);
                 int _south_pollout_handler(const south_type::handle_type& stream, event_mask& revents);
                 size_type _handle(south_type& interface, const south_type::handle_type& stream, event_mask& revents);
+
+                bool _passthrough;
         };
     }
 }
@@ -0,0 +1,190 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#pragma once
+#ifndef CLOUDBUS_SESSIONS
+#define CLOUDBUS_SESSIONS
+namespace cloudbus {
+    /* Sessions are threaded onto intrusive lists in insertion order: *
+     * one list of every session, and one list per north stream, per  *
+     * south stream and per uuid node. The list heads are hashed, so  *
+     * finding the sessions of a stream or a uuid and removing a      *
+     * session are both O(1). Streams are keyed by address, which is  *
+     * stable since each session holds a weak_ptr to the stream's     *
+     * control block.                                                 */
+    template<class ConnectionT>
+    class session_table {
+        public:
+            using value_type = ConnectionT;
+            using uuid_type = typename value_type::uuid_type;
+            using size_type = std::size_t;
+            enum links {ALL, NORTH, SOUTH, NODE, NLINKS};
+
+        private:
+            using key_type = const void*;
+            struct node {
+                value_type value;
+                std::array<node*, NLINKS> prev, next;
+                key_type north, south;
+                std::uint64_t nid;
+            };
+            struct list {
+                node *head, *tail;
+            };
+            template<class K>
+            using lists_type = std::unordered_map<K, list>;
+
+        public:
+            template<int L, bool Reverse=false>
+            class basic_iterator {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = ConnectionT;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = value_type*;
+                    using reference = value_type&;
+
+                    basic_iterator(node *n = nullptr): _node{n} {}
+                    reference operator*() const { return _node->value; }
+                    pointer operator->() const { return &_node->value; }
+                    basic_iterator& operator++() { _node = Reverse ? _node->prev[L] : _node->next[L]; return *this; }
+                    basic_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+                    bool operator==(const basic_iterator& other) const { return _node == other._node; }
+                    bool operator!=(const basic_iterator& other) const { return _node != other._node; }
+
+                private:
+                    node *_node;
+                    friend class session_table;
+            };
+            template<int L, bool Reverse=false>
+            struct range {
+                basic_iterator<L, Reverse> first;
+                basic_iterator<L, Reverse> begin() const { return first; }
+                basic_iterator<L, Reverse> end() const { return basic_iterator<L, Reverse>(); }
+                bool empty() const { return first == end(); }
+            };
+            using iterator = basic_iterator<ALL>;
+
+            session_table() = default;
+
+            iterator begin() const { return iterator(_all.head); }
+            iterator end() const { return iterator(); }
+            size_type size() const { return _size; }
+            bool empty() const { return !_size; }
+
+            template<class Ptr>
+            range<NORTH> north(const Ptr& ptr) const { return {_find(_north, key(ptr))}; }
+            template<class Ptr>
+            range<SOUTH> south(const Ptr& ptr) const { return {_find(_south, key(ptr))}; }
+            /* the sessions of a south stream, newest first. */
+            template<class Ptr>
+            range<SOUTH, true> rsouth(const Ptr& ptr) const { return {_find(_south, key(ptr), true)}; }
+            /* every session whose uuid shares the node of uuid. */
+            range<NODE> uuid(const uuid_type& uuid) const { return {_find(_nodes, nodeid(uuid))}; }
+
+            iterator insert(value_type&& value) {
+                auto *n = new node{std::move(value), {}, {}, nullptr, nullptr, 0};
+                n->north = key(n->value.north);
+                n->south = key(n->value.south);
+                n->nid = nodeid(n->value.uuid);
+                _link<ALL>(_all, n);
+                _link<NORTH>(_north[n->north], n);
+                _link<SOUTH>(_south[n->south], n);
+                _link<NODE>(_nodes[n->nid], n);
+                ++_size;
+                return iterator(n);
+            }
+            /* returns the next session on the same list as it. */
+            template<int L, bool Reverse>
+            basic_iterator<L, Reverse> erase(basic_iterator<L, Reverse> it) {
+                node *n = it._node, *next = Reverse ? n->prev[L] : n->next[L];
+                _unlink<ALL>(_all, n);
+                _unlink<NORTH>(_north, n->north, n);
+                _unlink<SOUTH>(_south, n->south, n);
+                _unlink<NODE>(_nodes, n->nid, n);
+                delete n;
+                --_size;
+                return basic_iterator<L, Reverse>(next);
+            }
+
+            ~session_table() {
+                for(node *n = _all.head; n; ) {
+                    node *next = n->next[ALL];
+                    delete n;
+                    n = next;
+                }
+            }
+
+            session_table(const session_table& other) = delete;
+            session_table& operator=(const session_table& other) = delete;
+            session_table(session_table&& other) = delete;
+            session_table& operator=(session_table&& other) = delete;
+
+        private:
+            list _all{};
+            lists_type<key_type> _north, _south;
+            lists_type<std::uint64_t> _nodes;
+            size_type _size{0};
+
+            template<class T>
+            static key_type key(const std::shared_ptr<T>& ptr) { return ptr.get(); }
+            template<class T>
+            static key_type key(const std::weak_ptr<T>& ptr) { return ptr.lock().get(); }
+            static std::uint64_t nodeid(const uuid_type& uuid) {
+                std::uint64_t nid = 0;
+                std::memcpy(&nid, uuid.node, sizeof(uuid.node));
+                return nid;
+            }
+            template<class K>
+            static node *_find(const lists_type<K>& lists, const K& k, bool tail=false) {
+                auto it = lists.find(k);
+                if(it == lists.end())
+                    return nullptr;
+                return tail ? it->second.tail : it->second.head;
+            }
+            template<int L>
+            static void _link(list& l, node *n) {
+                n->prev[L] = l.tail;
+                n->next[L] = nullptr;
+                if(l.tail)
+                    l.tail->next[L] = n;
+                else l.head = n;
+                l.tail = n;
+            }
+            template<int L>
+            static void _unlink(list& l, node *n) {
+                if(n->prev[L])
+                    n->prev[L]->next[L] = n->next[L];
+                else l.head = n->next[L];
+                if(n->next[L])
+                    n->next[L]->prev[L] = n->prev[L];
+                else l.tail = n->prev[L];
+            }
+            template<int L, class K>
+            static void _unlink(lists_type<K>& lists, const K& k, node *n) {
+                auto it = lists.find(k);
+                _unlink<L>(it->second, n);
+                if(!it->second.head)
+                    lists.erase(it);
+            }
+    };
+}
+#endif
@@ -16,81 +16,186 @@
 #include "connector_timerqueue.hpp"
 namespace cloudbus {
     namespace {
-        template<class T>
-        static bool owner_equal(const std::weak_ptr<T>& p1, const std::weak_ptr<T>& p2){
-            return !p1.owner_before(p2) && !p2.owner_before(p1);
+        using tick_type = TimerQueue::tick_type;
+        using milliseconds = std::chrono::milliseconds;
+        static constexpr tick_type MASK = TimerQueue::SLOTS-1;
+        static constexpr tick_type MAX_DELTA = (tick_type(1) << (TimerQueue::LEVEL_BITS*TimerQueue::LEVELS))-1;
+        template<class Slot, class Event>
+        static void push_back(Slot& slot, Event *event){
+            event->slot = &slot;
+            event->next = nullptr;
+            event->prev = slot.tail;
+            if(slot.tail)
+                slot.tail->next = event;
+            else slot.head = event;
+            slot.tail = event;
         }
-        template<class T>
-        static bool shrink_to_fit(std::vector<T>& vec){
-            static constexpr std::size_t THRESH = 256;
-            bool resized = false;
-            const std::size_t capacity = vec.capacity();
-            if( capacity > THRESH &&
-                vec.size() < capacity/8
-            ){
-                vec  = std::vector<T>(
-                    std::make_move_iterator(vec.begin()),
-                    std::make_move_iterator(vec.end())
-                );
-                resized = true;
+        template<class Slot, class Event>
+        static void unlink(Slot& slot, Event *event){
+            if(event->prev)
+                event->prev->next = event->next;
+            else slot.head = event->next;
+            if(event->next)
+                event->next->prev = event->prev;
+            else slot.tail = event->prev;
+            event->slot = nullptr;
+        }
+    }
+    TimerQueue::TimerQueue():
+        _base{std::chrono::steady_clock::now()},
+        _now{0}, _wheel{}, _due{}, _keys{}, _size{0}
+    {}
+    TimerQueue::tick_type TimerQueue::_tick(const TimePoint& time, bool roundup) const {
+        if(time <= _base)
+            return 0;
+        auto ms = std::chrono::duration_cast<milliseconds>(time - _base);
+        if(roundup && _base + ms < time)
+            ++ms;
+        return ms.count();
+    }
+    TimerQueue::slot_type& TimerQueue::_slot(tick_type expiry) {
+        const tick_type delta = expiry - _now;
+        std::size_t level = 0;
+        while(level < LEVELS-1 && delta >> (LEVEL_BITS*(level+1)))
+            ++level;
+        return _wheel[level][(expiry >> (LEVEL_BITS*level)) & MASK];
+    }
+    void TimerQueue::_schedule(TimeoutEvent *event) {
+        if(event->expiry <= _now)
+            return push_back(_due, event);
+        if(event->expiry - _now > MAX_DELTA)
+            event->expiry = _now + MAX_DELTA;
+        return push_back(_slot(event->expiry), event);
+    }
+    void TimerQueue::_cascade() {
+        /* each level is re-sorted into the levels below it once *
+         * the level below has wrapped around.                    */
+        for(std::size_t level = 1; level < LEVELS; ++level) {
+            const auto idx = (_now >> (LEVEL_BITS*level)) & MASK;
+            auto& slot = _wheel[level][idx];
+            auto *event = slot.head;
+            slot = slot_type{};
+            while(event) {
+                auto *next = event->next;
+                _schedule(event);
+                event = next;
             }
-            return resized;
-        }        
-    }    
+            if(idx)
+                break;
+        }
+    }
     void TimerQueue::addEvent(weak_ptr wp, const TimePoint& time, Callback&& func)
     {
-        using std::swap;
-        auto begin = events_.begin(), end = events_.end();
-        auto match = end;
-        for(auto it=begin; it != end; ++it) {
-            if(owner_equal(wp, it->streamPtr))
-                match = it;
-            if(time < it->expiryTime) {
-                if(match != end) {
-                    swap(*match, *it);
-                    return (void)(it->expiryTime = time);
-                } else {
-                    events_.insert(it, {std::move(func), wp, time});
-                    return (void)shrink_to_fit(events_);
-                }
-            }
-            if(match != end) {
-                swap(*match, *it);
-                match = it;
+        const void *key = wp.lock().get();
+        TimeoutEvent *event = nullptr;
+        if(key) {
+            if(auto it = _keys.find(key); it != _keys.end()) {
+                event = it->second;
+                unlink(*event->slot, event);
             }
         }
-        if(match == end) {
-            events_.insert(end, {std::move(func), wp, time});
-            return (void)shrink_to_fit(events_);
-        } else {
-            match->expiryTime = time;
+        if(!event) {
+            event = new TimeoutEvent{std::move(func), std::move(wp), key, 0, nullptr, nullptr, nullptr};
+            if(key)
+                _keys.emplace(key, event);
+            ++_size;
         }
+        event->expiry = _tick(time, true);
+        _schedule(event);
+    }
+    bool TimerQueue::cancel(const weak_ptr& wp) {
+        const void *key = wp.lock().get();
+        if(!key)
+            return false;
+        auto it = _keys.find(key);
+        if(it == _keys.end())
+            return false;
+        auto *event = it->second;
+        _keys.erase(it);
+        unlink(*event->slot, event);
+        delete event;
+        --_size;
+        return true;
     }
-    std::size_t TimerQueue::processEvents() {
-        auto currentTime = std::chrono::steady_clock::now();
-        std::size_t processedCount = 0;
-        auto begin = events_.begin(), end = events_.end();
-        auto first_not_expired = std::find_if(
-                begin,
-                end,
-            [&](const auto& event){
-                return event.expiryTime > currentTime;
+    std::size_t TimerQueue::processEvents(const TimePoint& time) {
+        const tick_type target = _tick(time, false);
+        if(!_size)
+            _now = std::max(_now, target);
+        while(_now < target) {
+            /* skip ahead to the next occupied slot or level wrap. */
+            const tick_type wrap = (_now | MASK) + 1;
+            const tick_type last = std::min(wrap, target);
+            tick_type t = _now + 1;
+            while(t < last && !_wheel[0][t & MASK].head)
+                ++t;
+            _now = t;
+            if(!(_now & MASK))
+                _cascade();
+            auto& slot = _wheel[0][_now & MASK];
+            for(auto *event = slot.head; event; ) {
+                auto *next = event->next;
+                push_back(_due, event);
+                event = next;
             }
-        );
-        if (first_not_expired == begin)
+            slot = slot_type{};
+        }
+        if(!_due.head)
             return 0;
         std::vector<Callback> callbacks_to_run;
-        callbacks_to_run.reserve(std::distance(begin, first_not_expired));
-        for (auto it = begin; it != first_not_expired; ++it) {
-            callbacks_to_run.push_back(std::move(it->callback));
-            ++processedCount;
+        for(auto *event = _due.head; event; ) {
+            auto *next = event->next;
+            if(event->key)
+                _keys.erase(event->key);
+            callbacks_to_run.push_back(std::move(event->callback));
+            delete event;
+            event = next;
         }
-        events_.erase(begin, first_not_expired);
-        for (auto& cb : callbacks_to_run) {
+        _due = slot_type{};
+        _size -= callbacks_to_run.size();
+        for(auto& cb: callbacks_to_run) {
             if(cb) {
                 cb();
             }
         }
-        return processedCount;
-    }    
+        return callbacks_to_run.size();
+    }
+    TimerQueue::TimePoint TimerQueue::next() const {
+        if(_due.head)
+            return _base + milliseconds(_now);
+        if(!_size)
+            return TimePoint::max();
+        tick_type next = -1;
+        for(tick_type t = _now+1; t <= _now+MASK; ++t) {
+            if(_wheel[0][t & MASK].head) {
+                next = t;
+                break;
+            }
+        }
+        /* a higher level slot is a lower bound, its timers *
+         * are re-sorted when the slot comes due.           */
+        for(std::size_t level = 1; level < LEVELS; ++level) {
+            const tick_type shift = LEVEL_BITS*level, cur = _now >> shift;
+            for(tick_type k = 1; k <= SLOTS; ++k) {
+                if(_wheel[level][(cur+k) & MASK].head) {
+                    next = std::min(next, (cur+k) << shift);
+                    break;
+                }
+            }
+        }
+        return _base + milliseconds(next);
+    }
+    TimerQueue::~TimerQueue() {
+        auto clear = [](slot_type& slot) {
+            for(auto *event = slot.head; event; ) {
+                auto *next = event->next;
+                delete event;
+                event = next;
+            }
+            slot = slot_type{};
+        };
+        for(auto& level: _wheel)
+            for(auto& slot: level)
+                clear(slot);
+        clear(_due);
+    }
 }
@@ -14,28 +14,69 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "../interfaces.hpp"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
 #pragma once
 #ifndef CLOUDBUS_TIMERQUEUE
 #define CLOUDBUS_TIMERQUEUE
 namespace cloudbus {
+    /* Hierarchical timing wheel with millisecond ticks. Four levels *
+     * of 256 slots cover 2^32 ms, timers further out are clamped.   *
+     * Each stream owns at most one timer, so adding a timer for a   *
+     * stream that already has one reschedules it and keeps the    *
+     * callback that it was first added with.                        */
     class TimerQueue {
         public:
             using TimePoint = std::chrono::steady_clock::time_point;
             using Callback = std::function<void()>;
             using weak_ptr = std::weak_ptr<interface_base::stream_type>;
+            using tick_type = std::uint64_t;
+            static constexpr std::size_t LEVEL_BITS = 8;
+            static constexpr std::size_t SLOTS = 1 << LEVEL_BITS;
+            static constexpr std::size_t LEVELS = 4;
 
-            // Struct to hold the event details
+            TimerQueue();
+            void addEvent(weak_ptr wp, const TimePoint& time, Callback&& func);
+            bool cancel(const weak_ptr& wp);
+            std::size_t processEvents(const TimePoint& time = std::chrono::steady_clock::now());
+            /* Lower bound on the next expiry, TimePoint::max() if empty. */
+            TimePoint next() const;
+            std::size_t size() const { return _size; }
+
+            ~TimerQueue();
+
+            TimerQueue(const TimerQueue& other) = delete;
+            TimerQueue& operator=(const TimerQueue& other) = delete;
+            TimerQueue(TimerQueue&& other) = delete;
+            TimerQueue& operator=(TimerQueue&& other) = delete;
+
+        private:
+            struct TimeoutEvent;
+            struct slot_type {
+                TimeoutEvent *head, *tail;
+            };
             struct TimeoutEvent {
                 Callback callback;
                 weak_ptr streamPtr;
-                TimePoint expiryTime;
+                const void *key;
+                tick_type expiry;
+                slot_type *slot;
+                TimeoutEvent *prev, *next;
             };
+            using wheel_type = std::array<std::array<slot_type, SLOTS>, LEVELS>;
 
-            TimerQueue() = default;
-            void addEvent(weak_ptr wp, const TimePoint& time, Callback&& func);
-            std::size_t processEvents();
-        private:
-            std::vector<TimeoutEvent> events_;
+            TimePoint _base;
+            tick_type _now;
+            wheel_type _wheel;
+            slot_type _due;
+            std::unordered_map<const void*, TimeoutEvent*> _keys;
+            std::size_t _size;
+
+            tick_type _tick(const TimePoint& time, bool roundup) const;
+            slot_type& _slot(tick_type expiry);
+            void _schedule(TimeoutEvent *event);
+            void _cascade();
     };
 }
 #endif
@@ -14,9 +14,15 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "connectors.hpp"
+#include "../logging.hpp"
+#include "../metrics.hpp"
+#include <cstring>
+#include <sstream>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/resource.h>
 #include <sys/un.h>
+#include <netdb.h>
 namespace cloudbus {
     namespace {
         static void throw_system_error(const std::string& what) {
@@ -35,16 +41,42 @@ namespace cloudbus {
                 throw_system_error("Unable to set the socket to nonblocking mode.");
             return fd;
         }
+        /* the backend as it was configured, e.g. tcp://127.0.0.1:8080. */
+        static std::string backend_name(interface_base& interface) {
+            std::string scheme = interface.protocol();
+            std::transform(scheme.begin(), scheme.end(), scheme.begin(), [](const unsigned char c){ return std::tolower(c); });
+            if(!interface.uri().empty())
+                return scheme.empty() ? interface.uri() : scheme + "://" + interface.uri();
+            if(interface.addresses().empty())
+                return scheme;
+            const auto&[addr, addrlen, ttl, weight] = interface.addresses().front();
+            const auto *sa = reinterpret_cast<const struct sockaddr*>(&addr);
+            if(sa->sa_family == AF_UNIX)
+                return scheme + "://" + reinterpret_cast<const struct sockaddr_un*>(sa)->sun_path;
+            char host[NI_MAXHOST], port[NI_MAXSERV];
+            if(getnameinfo(sa, addrlen, host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV))
+                return scheme;
+            return (sa->sa_family == AF_INET6) ?
+                scheme + "://[" + host + "]:" + port :
+                scheme + "://" + host + ":" + port;
+        }
     }
     connector_base::connector_base(
         const config::section& section,
         int mode
     ):
         _north{}, _south{}, _connections{},
-        _timeouts{},
-        _mode{mode}, _drain{0}
+        _index{}, _timeouts{},
+        _mode{mode}, _drain{0},
+        _workers{workers(section)},
+        _idle{BUFFER_IDLE}, _slow{SLOW_SESSION},
+        _sweep{}, _publish{},
+        _north_bytes{0}, _south_bytes{0},
+        _phases{}, _slow_sessions{0},
+        _unpublished{false}
     {
         short dir=0;
+        std::size_t budget = ::io::buffers::sockbuf::RECV_BUDGET, zerocopy = 0;
         interface_base::options_type soptions, noptions;
         for(const auto&[key, value]: section){
             std::string k = key;
@@ -62,6 +94,44 @@ namespace cloudbus {
                 std::transform(v.begin(), v.end(), v.begin(), [](const unsigned char c){ return std::toupper(c); });
                 if(v == "FULL_DUPLEX")
                     _mode = FULL_DUPLEX;
+            } else if(k == "WORKERS" || k == "PASSTHROUGH") {
+                continue;
+            } else if(k == "RECV_BUDGET") {
+                std::size_t pos = 0;
+                try {
+                    budget = std::stoul(value, &pos);
+                } catch(const std::exception& e) {
+                    throw std::invalid_argument("Invalid recv_budget: " + value);
+                }
+                if(pos != value.size() || !budget)
+                    throw std::invalid_argument("Invalid recv_budget: " + value);
+            } else if(k == "BUFFER_IDLE") {
+                std::size_t pos = 0;
+                try {
+                    _idle = duration_type(std::stol(value, &pos));
+                } catch(const std::exception& e) {
+                    throw std::invalid_argument("Invalid buffer_idle: " + value);
+                }
+                if(pos != value.size() || _idle.count() < 0)
+                    throw std::invalid_argument("Invalid buffer_idle: " + value);
+            } else if(k == "SLOW_SESSION") {
+                std::size_t pos = 0;
+                try {
+                    _slow = duration_type(std::stol(value, &pos));
+                } catch(const std::exception& e) {
+                    throw std::invalid_argument("Invalid slow_session: " + value);
+                }
+                if(pos != value.size() || _slow.count() < 0)
+                    throw std::invalid_argument("Invalid slow_session: " + value);
+            } else if(k == "ZEROCOPY") {
+                std::size_t pos = 0;
+                try {
+                    zerocopy = std::stoul(value, &pos);
+                } catch(const std::exception& e) {
+                    throw std::invalid_argument("Invalid zerocopy: " + value);
+                }
+                if(pos != value.size())
+                    throw std::invalid_argument("Invalid zerocopy: " + value);
             } else {
                 if(!dir)
                     continue;
@@ -75,13 +145,196 @@ namespace cloudbus {
             throw std::invalid_argument("A service must be configued with a bind address.");
         if(south().empty())
             throw std::invalid_argument("A service must be configured with at least one backend.");
-        for(auto& n: north())
+        for(auto& n: north()) {
             n.options() = noptions;
-        for(auto& s: south())
+            n.recvbudget() = budget;
+            n.zerocopy() = zerocopy;
+        }
+        for(auto& s: south()) {
             s.options() = soptions;
+            s.recvbudget() = budget;
+            s.zerocopy() = zerocopy;
+        }
         if(_mode == FULL_DUPLEX && south().size() > messages::CLOCK_SEQ_MAX)
             throw std::invalid_argument("The service fanout ratio will overflow the UUID clock_seq.");
     }
+    void connector_base::release_idle(const clock_type::time_point& t) {
+        if(!_idle.count() || t < _sweep)
+            return;
+        if(_sweep != clock_type::time_point()) {
+            for(auto *interfaces: {&_north, &_south})
+                for(auto& interface: *interfaces)
+                    for(auto& hnd: interface.streams())
+                        std::get<interface_base::stream_ptr>(hnd)->release();
+            _release_idle();
+        }
+        _sweep = t + _idle;
+    }
+    void connector_base::sent(const interface_base::stream_ptr& sp) {
+        using time_point = connection_type::time_point;
+        /* sessions are marked as the stream drains, so the unmarked *
+         * ones are always the newest and the walk stops at the first *
+         * marked one.                                                */
+        time_point t{};
+        for(auto& conn: _connections.rsouth(sp)) {
+            auto& sent = conn.timestamps->at(connection_type::SENT);
+            if(sent != time_point())
+                break;
+            if(t == time_point())
+                t = clock_type::now();
+            sent = t;
+        }
+    }
+    void connector_base::complete(const connection_type& conn) {
+        using time_point = connection_type::time_point;
+        using milliseconds = std::chrono::milliseconds;
+        const auto& times = *conn.timestamps;
+        /* sessions that never responded have no phases to speak of. */
+        if(times[connection_type::RESPONSE] == time_point())
+            return;
+        const auto start = times[connection_type::HALF_OPEN], end = times[connection_type::CLOSED];
+        std::array<time_point, stats::NPHASES+1> bounds = {
+            start,
+            times[connection_type::SENT],
+            times[connection_type::REQUEST],
+            times[connection_type::RESPONSE],
+            end
+        };
+        /* marks that are missing or out of order clamp to the *
+         * previous one, so the phases add up to the session.   */
+        for(std::size_t i=1; i < bounds.size(); ++i)
+            bounds[i] = std::clamp(bounds[i], bounds[i-1], end);
+        for(std::size_t i=0; i < _phases.size(); ++i)
+            _phases[i].record(bounds[i+1]-bounds[i]);
+        if(!_slow.count() || end-start < _slow)
+            return;
+        ++_slow_sessions;
+        static thread_local Logger::rate_limit limit;
+        Logger::getInstance().log(Logger::Level::WARNING, limit, 0, [&](){
+            const auto ms = [](const auto& d){
+                return std::to_string(std::chrono::duration_cast<milliseconds>(d).count()) + "ms";
+            };
+            std::stringstream ss;
+            ss << "Slow session " << conn.uuid << ": " << ms(end-start)
+                << " (connect " << ms(bounds[stats::CONNECT+1]-bounds[stats::CONNECT])
+                << ", upload " << ms(bounds[stats::UPLOAD+1]-bounds[stats::UPLOAD])
+                << ", think " << ms(bounds[stats::THINK+1]-bounds[stats::THINK])
+                << ", download " << ms(bounds[stats::DOWNLOAD+1]-bounds[stats::DOWNLOAD]) << ").";
+            return ss.str();
+        });
+    }
+    void connector_base::publish(const clock_type::time_point& t) {
+        auto *slot = stats::local();
+        if(!slot)
+            return;
+        if(t < _publish) {
+            _unpublished = true;
+            return;
+        }
+        std::uint64_t sessions[stats::NSTATES] = {};
+        for(const auto& conn: _connections)
+            ++sessions[conn.state];
+        struct rusage usage = {};
+        getrusage(RUSAGE_THREAD, &usage);
+        /* readers retry while the record is open, so keep it short. */
+        auto& rec = stats::begin(*slot);
+        rec.updated = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+        rec.arrivals = metrics::get().arrivals().load(std::memory_order_relaxed);
+        std::copy(std::begin(sessions), std::end(sessions), rec.sessions);
+        rec.north_bytes = _north_bytes;
+        rec.south_bytes = _south_bytes;
+        const auto& buffers = ::io::buffers::pool::stats();
+        rec.pool_hits = buffers.hits.load(std::memory_order_relaxed);
+        rec.pool_misses = buffers.misses.load(std::memory_order_relaxed);
+        std::copy(_phases.begin(), _phases.end(), rec.phases);
+        rec.slow = _slow_sessions;
+        rec.user_us = usage.ru_utime.tv_sec*1000000 + usage.ru_utime.tv_usec;
+        rec.system_us = usage.ru_stime.tv_sec*1000000 + usage.ru_stime.tv_usec;
+        rec.loop = loop_metrics::local();
+        rec.nbackends = std::min(_south.size(), stats::MAX_BACKENDS);
+        for(std::size_t i=0; i < rec.nbackends; ++i) {
+            auto& interface = _south[i];
+            auto& backend = rec.backends[i];
+            const auto uri = backend_name(interface);
+            const auto len = std::min(uri.size(), sizeof(backend.uri)-1);
+            std::memcpy(backend.uri, uri.data(), len);
+            backend.uri[len] = '\0';
+            backend.streams = interface.streams().size();
+            backend.outstanding = 0;
+            std::uint64_t measured = 0, interarrival = 0, intercompletion = 0;
+            for(const auto& load: interface.loads()) {
+                backend.outstanding += load.outstanding;
+                if(load.measured) {
+                    ++measured;
+                    interarrival += load.interarrival.count();
+                    intercompletion += load.intercompletion.count();
+                }
+            }
+            backend.interarrival = measured ? interarrival/measured : 0;
+            backend.intercompletion = measured ? intercompletion/measured : 0;
+            backend.ttfb = interface.latency().ttfb;
+            backend.duration = interface.latency().duration;
+        }
+        stats::end(*slot);
+        _publish = t + std::chrono::milliseconds(stats::INTERVAL_MS);
+        _unpublished = false;
+    }
+    void connector_base::index(const interface_base::handle_type& hnd, const interface_type& interface) {
+        const auto&[ptr, sockfd] = hnd;
+        if(sockfd < 0)
+            return;
+        const std::size_t fd = sockfd;
+        if(fd >= _index.size())
+            _index.resize(std::max(fd+1, 2*_index.size()));
+        auto& entry = _index[fd];
+        entry.stream = ptr;
+        if(&interface >= _north.data() && &interface < _north.data()+_north.size()) {
+            entry.interface = &interface - _north.data();
+            entry.direction = NORTH;
+        } else {
+            entry.interface = &interface - _south.data();
+            entry.direction = SOUTH;
+        }
+    }
+    int connector_base::lookup(interface_base::native_handle_type sockfd, interface_type*& interface, interface_base::handle_type& hnd) {
+        if(sockfd < 0)
+            return NONE;
+        const std::size_t fd = sockfd;
+        if(fd >= _index.size())
+            return NONE;
+        auto& entry = _index[fd];
+        if(entry.direction == NONE)
+            return NONE;
+        /* an entry is stale once its stream is gone or *
+         * the descriptor has been closed and reused.   */
+        if(auto ptr = entry.stream.lock(); ptr && ptr->native_handle() == sockfd) {
+            interface = &(entry.direction == NORTH ? _north : _south)[entry.interface];
+            hnd = std::make_tuple(std::move(ptr), sockfd);
+            return entry.direction;
+        }
+        entry = index_entry{};
+        return NONE;
+    }
+    int connector_base::workers(const config::section& section) {
+        int n = 1;
+        for(const auto&[key, value]: section) {
+            std::string k = key;
+            std::transform(k.begin(), k.end(), k.begin(), [](const unsigned char c){ return std::toupper(c); });
+            if(k == "WORKERS") {
+                std::size_t pos = 0;
+                try {
+                    n = std::stoi(value, &pos);
+                } catch(const std::exception& e) {
+                    throw std::invalid_argument("Invalid workers: " + value);
+                }
+                if(pos != value.size() || n < 1 || n > MAX_WORKERS)
+                    throw std::invalid_argument("Invalid workers: " + value);
+            }
+        }
+        return n;
+    }
     interface_base::native_handle_type connector_base::make_north(const config::address_type& address){
         if(address.index() != config::SOCKADDR)
             return -1;
@@ -92,6 +345,7 @@ namespace cloudbus {
             auto& hnd = _north.back().make(addr->sa_family, SOCK_STREAM, 0, std::ios_base::openmode());
             auto& sockfd = std::get<interface_base::native_handle_type>(hnd);
             set_flags(sockfd);
+            index(hnd, _north.back());
             if(protocol == "TCP") {
                 int reuseaddr = 1;
                 if(setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &reuseaddr, sizeof(reuseaddr))) {
@@ -100,6 +354,15 @@ namespace cloudbus {
                         "Unable to set SO_REUSEADDR."
                     );
                 }
+                /* every worker binds its own listener and the *
+                 * kernel shards new connections across them.  */
+                if(_workers > 1) {
+                    int reuseport = 1;
+                    if(setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &reuseport, sizeof(reuseport)))
+                        throw_system_error("Unable to set SO_REUSEPORT.");
+                }
+            } else if(_workers > 1) {
+                throw std::invalid_argument("Multiple workers require a TCP bind address.");
             }
             if(bind(sockfd, addr, addrlen)) {
                 if(protocol == "UNIX")
@@ -14,9 +14,12 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "connector_timerqueue.hpp"
+#include "connector_sessions.hpp"
 #include "../config.hpp"
 #include "../messages.hpp"
 #include "../dns.hpp"
+#include "../stats.hpp"
+#include "../logging.hpp"
 #pragma once
 #ifndef CLOUDBUS_CONNECTOR
 #define CLOUDBUS_CONNECTOR
@@ -27,7 +30,12 @@ namespace cloudbus {
         using socket_type = WeakPtr;
         using clock_type = std::chrono::steady_clock;
         using time_point = clock_type::time_point;
-        using times_type = std::array<time_point, 4>;
+        enum states {HALF_OPEN, OPEN, HALF_CLOSED, CLOSED};
+        /* timestamps past the states mark events within a session: *
+         * its first bytes leaving the south stream, the last       *
+         * request bytes and the first response bytes.              */
+        enum marks {SENT=CLOSED+1, REQUEST, RESPONSE, NTIMESTAMPS};
+        using times_type = std::array<time_point, NTIMESTAMPS>;
         using times_ptr = std::unique_ptr<times_type>;
         static connection make(
             const uuid_type& uuid,
@@ -47,7 +55,6 @@ namespace cloudbus {
                 state
             };
         }
-        enum states {HALF_OPEN, OPEN, HALF_CLOSED, CLOSED};
         uuid_type uuid;
         socket_type north, south;
         times_ptr timestamps;
@@ -69,11 +76,28 @@ namespace cloudbus {
 
             using connection_type = connection<stream_ptr>;
             using clock_type = connection_type::clock_type;
-            using connections_type = std::vector<connection_type>;
+            using connections_type = session_table<connection_type>;
+
+            using duration_type = std::chrono::milliseconds;
+            using phases_type = std::array<histogram, stats::NPHASES>;
+
+            /* Slot sockfd of the index names the interface and *
+             * direction of the stream that owns sockfd.        */
+            struct index_entry {
+                stream_ptr stream;
+                std::size_t interface;
+                int direction;
+            };
+            using index_type = std::vector<index_entry>;
 
             enum modes {HALF_DUPLEX, FULL_DUPLEX};
+            enum directions {NONE, NORTH, SOUTH};
+            static constexpr int MAX_WORKERS = 256;
+            static constexpr duration_type BUFFER_IDLE = duration_type(30000);
+            static constexpr duration_type SLOW_SESSION = duration_type(0);
 
             explicit connector_base(const config::section& section, int mode=HALF_DUPLEX);
+            static int workers(const config::section& section);
 
             interface_base::native_handle_type make_north(const config::address_type& address);
             int make_south(const config::address_type& address);
@@ -84,6 +108,34 @@ namespace cloudbus {
             TimerQueue& timeouts() { return _timeouts; }
             int& mode() { return _mode; }
             int& drain() { return _drain; }
+            int workers() const { return _workers; }
+            duration_type& idle() { return _idle; }
+            /* Sessions that take at least slow() are logged, 0 disables it. */
+            duration_type& slow() { return _slow; }
+            /* Releases the buffers of streams that were quiet for idle(). */
+            void release_idle(const clock_type::time_point& t = clock_type::now());
+            void index(const interface_base::handle_type& hnd, const interface_type& interface);
+            /* Finds the stream that owns sockfd and returns its direction, *
+             * NONE if sockfd isn't indexed, e.g. a resolver socket. Every *
+             * stream must be passed to index() once it has a socket.      */
+            int lookup(interface_base::native_handle_type sockfd, interface_type*& interface, interface_base::handle_type& hnd);
+            /* Payload bytes routed from the north and from the south. */
+            std::uint64_t& north_bytes() { return _north_bytes; }
+            std::uint64_t& south_bytes() { return _south_bytes; }
+            /* Marks the sessions whose first bytes have left the south *
+             * stream sp, call it whenever sp has been drained.         */
+            void sent(const interface_base::stream_ptr& sp);
+            /* Folds a session that has just closed into phases(). */
+            void complete(const connection_type& conn);
+            const phases_type& phases() const { return _phases; }
+            std::uint64_t slow_sessions() const { return _slow_sessions; }
+            /* Publishes the node's statistics to the calling thread's *
+             * slot, at most once per stats::INTERVAL_MS.               */
+            void publish(const clock_type::time_point& t = clock_type::now());
+            /* When the next publish is due, max() if nothing is unpublished. */
+            clock_type::time_point publish_due() const {
+                return _unpublished ? _publish : clock_type::time_point::max();
+            }
 
             virtual ~connector_base();
 
@@ -93,11 +145,21 @@ namespace cloudbus {
             connector_base& operator=(const connector_base& other) = delete;
             connector_base& operator=(connector_base&& other) = delete;
 
+        protected:
+            virtual void _release_idle() {}
+
         private:
             interfaces _north, _south;
             connections_type _connections;
+            index_type _index;
             TimerQueue _timeouts;
-            int _mode, _drain;
+            int _mode, _drain, _workers;
+            duration_type _idle, _slow;
+            clock_type::time_point _sweep, _publish;
+            std::uint64_t _north_bytes, _south_bytes;
+            phases_type _phases;
+            std::uint64_t _slow_sessions;
+            bool _unpublished;
     };
 
     template<class HandlerT>
@@ -130,8 +192,19 @@ namespace cloudbus {
 
         protected:
             virtual size_type _handle(events_type& events) override {
-                auto handled = _resolver.handle(events);
-                Base::timeouts().processEvents();
+                size_type handled = 0;
+                {
+                    loop_metrics::timer timer(loop_metrics::RESOLVER);
+                    handled = _resolver.handle(events);
+                }
+                const auto t = Base::clock_type::now();
+                {
+                    loop_metrics::timer timer(loop_metrics::TIMERS);
+                    Base::timeouts().processEvents();
+                    Base::release_idle(t);
+                }
+                Base::publish(t);
+                Logger::rate_limit::flush(t);
                 return handled;
             }
 
@@ -214,6 +287,7 @@ namespace cloudbus {
             basic_connector& operator=(basic_connector&& other) = delete;
 
         protected:
+            virtual void _release_idle() override { MarshallerBase::marshaller().release(); }
             virtual int _route(
                 typename marshaller_type::north_format& buf,
                 north_type& interface,
@@ -14,6 +14,8 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "dns.hpp"
+#include "../logging.hpp"
+#include "../trace.hpp"
 #include <pcre2.h>
 #include <charconv>
 #include <mutex>
@@ -93,6 +95,17 @@ namespace cloudbus {
             iface.addresses(std::move(addrs));
             return ares_strerror(status);
         }
+        /* The error is always handled, only the log line is rate *
+         * limited. Each caller passes its own lambda type, so each *
+         * call site gets its own limit.                            */
+        template<class Fn>
+        static void log_ares_error(interface_base& iface, int status, Fn&& what){
+            static thread_local Logger::rate_limit limit;
+            const char *error = ares_handle_error(iface, status);
+            Logger::getInstance().log(Logger::Level::ERROR, limit, status, [&](){
+                return "ares error: " + what() + ": " + error;
+            });
+        }
         static std::string extract_protocol(const std::string& name) {
             auto start = std::find(name.cbegin(), name.cend(), '.'),
                 end = std::find(++start, name.cend(), '.');
@@ -325,10 +338,9 @@ namespace cloudbus {
                 case ARES_SUCCESS:
                     return ares_parse_srv_success(iface, channel, name, srv);
                 default:
-                    std::cerr << __FILE__ << ':' << __LINE__
-                        << ":ares error:"
-                        << ares_handle_error(iface, rc)
-                        << std::endl;
+                    log_ares_error(iface, rc, [](){
+                        return std::string("SRV reply");
+                    });
                     break;
             }
         }
@@ -344,16 +356,15 @@ namespace cloudbus {
             switch(rc) {
                 case ARES_SUCCESS:
                     if(ares_parse_naptr_success(iface, channel, subject, naptr)) {
-                        std::cerr << __FILE__ << ":" << __LINE__
-                            << ":ares error:" << ares_handle_error(iface, rc)
-                            << ":no NAPTR match." << std::endl;
+                        log_ares_error(iface, rc, [&](){
+                            return "subject=" + subject + " no NAPTR match";
+                        });
                     }
                     break;
                 default:
-                    std::cerr << __FILE__ << ':' << __LINE__
-                        << ":ares error:"
-                        << ares_handle_error(iface, rc)
-                        << std::endl;
+                    log_ares_error(iface, rc, [](){
+                        return std::string("NAPTR reply");
+                    });
                     break;
             }
         }
@@ -392,15 +403,15 @@ namespace cloudbus {
                 auto *args = static_cast<addrinfo_args*>(arg);
                 auto&[iface, hints, weight] = *args;
                 delete hints;
+                CLOUDBUS_PROBE(resolve_done, &iface, status);
                 switch(status) {
                     case ARES_SUCCESS:
                         ares_addrinfo_success(iface, weight, result);
                         break;
                     default:
-                        std::cerr << __FILE__ << ':' << __LINE__
-                            << ":ares error="
-                            << ares_handle_error(iface, status)
-                            << std::endl;
+                        log_ares_error(iface, status, [](){
+                            return std::string("getaddrinfo");
+                        });
                         break;
                 }
                 delete args;
@@ -413,16 +424,15 @@ namespace cloudbus {
             ){
                 auto *args = static_cast<ares_query_args*>(arg);
                 auto&[iface, channel, name, subject] = *args;
+                CLOUDBUS_PROBE(resolve_done, &iface, status);
                 switch(status) {
                     case ARES_SUCCESS:
                         ares_getsrv_success(iface, channel, name, abuf, alen);
                         break;
                     default:
-                        std::cerr << __FILE__ << ':' << __LINE__
-                            << ":name=" << name
-                            << " ares error="
-                            << ares_handle_error(iface, status)
-                            << std::endl;
+                        log_ares_error(iface, status, [&](){
+                            return "name=" + name;
+                        });
                         break;
                 }
                 delete args;
@@ -435,17 +445,15 @@ namespace cloudbus {
             ){
                 auto *args = static_cast<ares_query_args*>(arg);
                 auto&[iface, channel, name, subject] = *args;
+                CLOUDBUS_PROBE(resolve_done, &iface, status);
                 switch(status) {
                     case ARES_SUCCESS:
                         ares_getnaptr_success(iface, channel, subject, abuf, alen);
                         break;
                     default:
-                        std::cerr << __FILE__ << ':' << __LINE__
-                            << ":name=" << name
-                            << " subject=" << subject
-                            << " ares error="
-                            << ares_handle_error(iface, status)
-                            << std::endl;
+                        log_ares_error(iface, status, [&](){
+                            return "name=" + name + " subject=" + subject;
+                        });
                         break;
                 }
                 delete args;
@@ -523,6 +531,7 @@ namespace cloudbus {
             if(iface.protocol() == "TCP")
                 hints->ai_socktype = SOCK_STREAM;
             addrinfo_args *args = new addrinfo_args{iface, hints, weight};
+            CLOUDBUS_PROBE(resolve_start, &iface, name);
             return ares_getaddrinfo(
                 channel,
                 name, service,
@@ -537,6 +546,7 @@ namespace cloudbus {
             const std::string& name
         ){
             auto *args = new ares_query_args{iface, channel, name, ""};
+            CLOUDBUS_PROBE(resolve_start, &iface, name.c_str());
             return ares_query(
                 channel,
                 name.c_str(),
@@ -552,6 +562,7 @@ namespace cloudbus {
             const std::string& subject
         ){
             auto *args = new ares_query_args{iface, channel, name, subject};
+            CLOUDBUS_PROBE(resolve_start, &iface, name.c_str());
             return ares_query(
                 channel,
                 name.c_str(),
@@ -44,23 +44,20 @@ namespace cloudbus {
                             if(!sockev) {
                                 this->triggers().clear(sockfd);
                             } else {
-                                event_mask curr=0, set=0, unset=0;
+                                event_mask curr=this->triggers().interest(sockfd), set=0, unset=0;
                                 auto cit = std::find_if(
                                         events.cbegin(),
                                         events.cend(),
                                     [&](const auto& event){
-                                        if(event.fd==sockfd) {
-                                            curr = event.events;
-                                            if(event.revents && ++handled)
-                                                process_event(hnd);
-                                        }
+                                        if(event.fd==sockfd && event.revents && ++handled)
+                                            process_event(hnd);
                                         return event.fd==sockfd;
                                     }
                                 );
         
                                 if(cit == events.cend()){
                                     auto&[time, interval] = timeout();
-                                    if(clock_type::now() > time+interval && ++handled)
+                                    if(interval.count() > -1 && clock_type::now() > time+interval && ++handled)
                                         process_event(hnd);
                                 } else cit=events.erase(cit);
         
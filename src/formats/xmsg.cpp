@@ -14,6 +14,7 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "xmsg.hpp"
+#include "../io/pool.hpp"
 #include <algorithm>
 #include <cstring>
 namespace cloudbus{
@@ -22,8 +23,8 @@ namespace cloudbus{
             Base(),
             bufptr{nullptr}, bufsize{buflen}
         {
-            if( bufsize && !(bufptr=std::malloc(bufsize)) )
-                throw std::bad_alloc();
+            if(bufsize)
+                bufptr = ::io::buffers::pool::allocate(bufsize);
             char *base = static_cast<char*>(bufptr);
             setp(base, base+bufsize);
             setg(pbase(), pbase(), pptr());
@@ -90,10 +91,12 @@ namespace cloudbus{
             auto poff = pptr()-pbase(), goff = gptr()-eback();
             if(auto *lp = len(); lp && lp->length == pptr()-pbase())
                 return Base::overflow(ch);
+            try {
+                bufptr = ::io::buffers::pool::reallocate(bufptr, bufsize, bufsize+BUFINC);
+            } catch(const std::bad_alloc& e) {
+                return Base::overflow(ch);
+            }
             bufsize += BUFINC;
-            if(auto *ptr = std::realloc(bufptr, bufsize))
-                bufptr = ptr;
-            else return Base::overflow(ch);
             char *base = static_cast<char*>(bufptr);
             setp(base, base+bufsize);
             pbump(poff);
@@ -136,13 +139,13 @@ namespace cloudbus{
         }
         xmsgbuf::~xmsgbuf(){
             if(bufptr){
-                std::free(bufptr);
+                ::io::buffers::pool::deallocate(bufptr, bufsize);
                 bufptr = nullptr;
             }
         }
 
         xmsgstream::xmsgstream():
-            Base(&_buf), _buf{}
+            Base(&_buf), _buf{0}
         {}
 
         xmsgstream::xmsgstream(xmsgstream&& other) noexcept:
@@ -21,7 +21,56 @@ namespace cloudbus {
         static bool owner_equal(const std::shared_ptr<T>& p1, const std::shared_ptr<T>& p2){
             return !p1.owner_before(p2) && !p2.owner_before(p1);
         }
-    }    
+        static constexpr std::size_t span = 3;
+        static auto update_ewma(const interface_base::load_type::duration_type& delta) {
+            using duration_type = interface_base::load_type::duration_type;
+            auto denom = duration_type(span+1);
+            if(delta > duration_type::max()/2)
+            {
+                auto overflow = delta - duration_type::max() % delta;
+                auto rem1 = duration_type::max() % denom, rem2 = overflow % denom;
+                return duration_type(duration_type::max()/denom +
+                    overflow/denom +
+                    (rem1+rem2)/denom);
+            }
+            else if (delta < duration_type::min()/2)
+            {
+                auto underflow = delta - duration_type::min() % delta;
+                auto rem1 = duration_type::min() % denom, rem2 = underflow % denom;
+                return duration_type(duration_type::min()/denom +
+                    underflow/denom +
+                    (rem1+rem2)/denom);
+            } else return duration_type(2*delta/denom);
+        }
+        static bool measure(interface_base::load_type& load, const interface_base::load_type::time_point& t){
+            if(load.measured)
+                return true;
+            load.interarrival = load.intercompletion = interface_base::load_type::duration_type(0);
+            load.last_arrival = load.last_completion = t;
+            return !(load.measured = true);
+        }
+    }
+    interface_base::load_type::duration_type interface_base::load_type::arrival(const time_point& t){
+        ++outstanding;
+        if(!measure(*this, t))
+            return interarrival;
+        auto delta = std::chrono::duration_cast<duration_type>(t - last_arrival) - interarrival;
+        last_arrival = t;
+        return interarrival += update_ewma(delta);
+    }
+    interface_base::load_type::duration_type interface_base::load_type::completion(const time_point& t){
+        abandon();
+        if(!measure(*this, t))
+            return intercompletion;
+        auto delta = std::chrono::duration_cast<duration_type>(t - last_completion) - intercompletion;
+        last_completion = t;
+        return intercompletion += update_ewma(delta);
+    }
+    interface_base::latency_type& interface_base::latency(){
+        if(!_latency)
+            _latency = std::make_unique<latency_type>();
+        return *_latency;
+    }
     const interface_base::address_type interface_base::NULLADDR = interface_base::address_type{};
     interface_base::address_type interface_base::make_address(const struct sockaddr *addr, socklen_t addrlen, const ttl_type& ttl, const weight_type& weight){
         auto address = address_type();
@@ -63,9 +112,10 @@ namespace cloudbus {
         const duration_type& ttl
     ):
         _uri{uri}, _protocol{protocol},
-        _addresses{}, _streams{}, _pending{},
+        _addresses{}, _streams{}, _loads{}, _latency{}, _pending{},
         _idx{0}, _total_weight{0}, _prio{SIZE_MAX},
-        _options{}
+        _options{}, _budget{::io::buffers::sockbuf::RECV_BUDGET},
+        _zerocopy{0}
     {
         if(addr != nullptr && addrlen >= sizeof(sa_family_t))
             _addresses.push_back(make_address(addr, addrlen, std::make_tuple(clock_type::now(), ttl)));
@@ -83,9 +133,10 @@ namespace cloudbus {
         const std::string& uri
     ):
         _uri{uri}, _protocol{protocol},
-        _addresses{addresses}, _streams{}, _pending{},
+        _addresses{addresses}, _streams{}, _loads{}, _latency{}, _pending{},
         _idx{0}, _total_weight{0}, _prio{SIZE_MAX},
-        _options{}
+        _options{}, _budget{::io::buffers::sockbuf::RECV_BUDGET},
+        _zerocopy{0}
     {}
     interface_base::interface_base(
         addresses_type&& addresses,
@@ -94,9 +145,10 @@ namespace cloudbus {
     ):
         _uri{uri}, _protocol{protocol},
         _addresses{std::move(addresses)},
-        _streams{}, _pending{},
+        _streams{}, _loads{}, _latency{}, _pending{},
         _idx{0}, _total_weight{0}, _prio{SIZE_MAX},
-        _options{}
+        _options{}, _budget{::io::buffers::sockbuf::RECV_BUDGET},
+        _zerocopy{0}
     {}
     interface_base::interface_base(interface_base&& other) noexcept:
         interface_base()
@@ -212,6 +264,9 @@ namespace cloudbus {
                 return lptr.owner_before(rptr);
             }
         );
+        std::get<stream_ptr>(hnd)->recvbudget() = _budget;
+        std::get<stream_ptr>(hnd)->zerocopy() = _zerocopy;
+        _loads.insert(_loads.begin() + (ub - _streams.begin()), load_type{});
         ub = _streams.insert(ub, std::move(hnd));
         return *ub;
     }
@@ -222,8 +277,34 @@ namespace cloudbus {
         return make(make_handle(sockfd, connected));
     }
     interface_base::handles_type::iterator interface_base::erase(handles_type::const_iterator cit){
+        _loads.erase(_loads.begin() + (cit - _streams.cbegin()));
         return _streams.erase(cit);
     }
+    interface_base::load_type& interface_base::load(const handle_type& handle){
+        const std::less<const handle_type*> less;
+        const auto *first = _streams.data(), *last = first + _streams.size();
+        if(!less(&handle, first) && less(&handle, last))
+            return _loads[&handle - first];
+        if(auto *l = load(std::get<stream_ptr>(handle)))
+            return *l;
+        throw std::invalid_argument("Invalid handle: not a stream of this interface.");
+    }
+    interface_base::load_type *interface_base::load(const std::weak_ptr<stream_type>& ptr){
+        auto lb = std::lower_bound(
+                _streams.cbegin(),
+                _streams.cend(),
+                ptr,
+            [&](const auto& lhs, const auto& rhs) {
+                return std::get<stream_ptr>(lhs).owner_before(rhs);
+            }
+        );
+        if(lb == _streams.cend())
+            return nullptr;
+        const auto& sp = std::get<stream_ptr>(*lb);
+        if(sp.owner_before(ptr) || ptr.owner_before(sp))
+            return nullptr;
+        return &_loads[lb - _streams.cbegin()];
+    }
     interface_base::handles_type::iterator interface_base::erase(const handle_type& handle) {
         auto cit = std::lower_bound(
                 _streams.cbegin(),
@@ -319,10 +400,14 @@ namespace cloudbus {
         swap(lhs._protocol, rhs._protocol);
         swap(lhs._addresses, rhs._addresses);
         swap(lhs._streams, rhs._streams);
+        swap(lhs._loads, rhs._loads);
+        swap(lhs._latency, rhs._latency);
         swap(lhs._pending, rhs._pending);
         swap(lhs._idx, rhs._idx);
         swap(lhs._total_weight, rhs._total_weight);
         swap(lhs._prio, rhs._prio);
         swap(lhs._options, rhs._options);
+        swap(lhs._budget, rhs._budget);
+        swap(lhs._zerocopy, rhs._zerocopy);
     }
 }
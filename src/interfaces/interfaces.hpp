@@ -15,6 +15,7 @@
 */
 #include "../io.hpp"
 #include "../formats.hpp"
+#include "../metrics/metrics_histogram.hpp"
 #include <sstream>
 #include <functional>
 #pragma once
@@ -39,11 +40,40 @@ namespace cloudbus {
                 std::size_t count;
                 std::size_t priority;
             };
+            /* Latencies of the sessions that got a response: the *
+             * time to the first response byte and the duration.  */
+            struct latency_type {
+                histogram ttfb, duration;
+                latency_type& operator+=(const latency_type& other) {
+                    ttfb += other.ttfb;
+                    duration += other.duration;
+                    return *this;
+                }
+            };
+            /* Load on a stream, kept alongside its handle. The  *
+             * intervals are moving averages over recent sessions. */
+            struct load_type {
+                using clock_type = std::chrono::steady_clock;
+                using duration_type = std::chrono::milliseconds;
+                using time_point = clock_type::time_point;
+                duration_type interarrival, intercompletion;
+                time_point last_arrival, last_completion;
+                std::size_t outstanding;
+                bool measured;
+                /* allocated by the first session to get a response. */
+                std::unique_ptr<latency_type> latency;
+
+                duration_type arrival(const time_point& t=clock_type::now());
+                duration_type completion(const time_point& t=clock_type::now());
+                /* a session that ended without completing. */
+                void abandon() { if(outstanding) --outstanding; }
+            };
             using stream_type = ::io::streams::sockstream;
             using native_handle_type = stream_type::native_handle_type;
             using stream_ptr = std::shared_ptr<stream_type>;
             using handle_type = std::tuple<stream_ptr, native_handle_type>;
             using handles_type = std::vector<handle_type>;
+            using loads_type = std::vector<load_type>;
             using clock_type = std::chrono::system_clock;
             using time_point = clock_type::time_point;
             using duration_type = std::chrono::seconds;
@@ -89,6 +119,8 @@ namespace cloudbus {
             std::string nid();
             std::string& protocol() { return _protocol; }
             options_type& options() { return _options; }
+            std::size_t& recvbudget() { return _budget; }
+            std::size_t& zerocopy() { return _zerocopy; }
             std::size_t npending() const { return _pending.size(); }
             std::size_t total() const { return _total_weight; }
             std::string host();
@@ -99,6 +131,20 @@ namespace cloudbus {
             const addresses_type& addresses(addresses_type&& addrs);
 
             const handles_type& streams() const { return _streams; }
+            /* loads()[i] is the load on streams()[i]. */
+            const loads_type& loads() const { return _loads; }
+            load_type& load(const handle_type& handle);
+            load_type *load(const std::weak_ptr<stream_type>& ptr);
+            /* Latencies over every stream the interface has had. */
+            latency_type& latency();
+            /* Records a latency of a session on the stream of load. */
+            template<class Duration>
+            void record(load_type& load, histogram latency_type::*which, const Duration& d) {
+                if(!load.latency)
+                    load.latency = std::make_unique<latency_type>();
+                ((*load.latency).*which).record(d);
+                (latency().*which).record(d);
+            }
             handle_type& make(handle_type&& handle=make_handle());
             handle_type& make(int domain, int type, int protocol, std::ios_base::openmode which=(std::ios_base::in | std::ios_base::out));
             handle_type& make(native_handle_type sockfd, bool connected=false);
@@ -122,9 +168,12 @@ namespace cloudbus {
             std::string _uri, _protocol;
             addresses_type _addresses;
             handles_type _streams;
+            loads_type _loads;
+            std::unique_ptr<latency_type> _latency;
             callbacks_type _pending;
             std::size_t _idx, _total_weight, _prio;
             options_type _options;
+            std::size_t _budget, _zerocopy;
 
             friend void swap(interface_base& lhs, interface_base& rhs) noexcept;
     };
@@ -18,6 +18,7 @@
 #include <array>
 #include <vector>
 #include <tuple>
+#include <cstdint>
 #include <sys/socket.h>
 
 #pragma once
@@ -29,11 +30,22 @@ namespace io{
             using address_type = std::tuple<struct sockaddr_storage, socklen_t>;
             using ancillary_buffer = std::vector<char>;
             using data_buffer = struct iovec;
+            using data_buffers = std::vector<data_buffer>;
 
-            struct msghdr header;
             address_type addr;
             ancillary_buffer ancillary;
             data_buffer data;
+            /* Outbound data is chained across fixed-size segments *
+             * that double as the iovec array handed to sendmsg(). *
+             * Each iov_len counts the bytes written to a segment  *
+             * and offset counts the bytes of the first segment    *
+             * that have already been sent.                        */
+            data_buffers segments;
+            std::size_t offset;
+            /* The leading zcsegs segments are still referenced *
+             * by the MSG_ZEROCOPY send numbered zcseq.         */
+            std::size_t zcsegs;
+            std::uint32_t zcseq;
         };
         class sockbuf : public std::streambuf {
             public:
@@ -46,9 +58,11 @@ namespace io{
                 using size_type = std::size_t;
                 using buffer_type = std::shared_ptr<socket_message>;
                 using buffers_type = std::vector<buffer_type>;
+                using retired_type = std::vector<std::tuple<std::uint32_t, void*> >;
                 using native_handle_type = int;
                 static constexpr native_handle_type BAD_SOCKET = -1;
                 static constexpr size_type MIN_BUFSIZE = 32*1024;
+                static constexpr size_type RECV_BUDGET = 4*MIN_BUFSIZE;
 
                 sockbuf();
                 explicit sockbuf(native_handle_type sockfd, bool connected=false, std::ios_base::openmode which=(std::ios_base::in | std::ios_base::out));
@@ -60,6 +74,16 @@ namespace io{
                 native_handle_type& native_handle() { return _socket; }
                 int& err() { return _errno; }
                 const int& err() const { return _errno; }
+                size_type& recvbudget() { return _budget; }
+                size_type buffered() const { return egptr()-gptr(); }
+                /* Sends of at least zerocopy() bytes use MSG_ZEROCOPY, 0 disables it. */
+                size_type& zerocopy() { return _zerocopy; }
+                int reap();
+                /* Frees drained buffers if there was no I/O since the last call. */
+                bool release();
+                /* These go through the io_uring of this thread if it has one. */
+                int shutdown(int how);
+                native_handle_type accept();
 
                 ~sockbuf();
 
@@ -82,11 +106,20 @@ namespace io{
                 int _errno;
                 bool _connected;
                 std::ios_base::openmode _which;
+                size_type _budget;
+                size_type _zerocopy;
+                bool _zcenabled;
+                std::uint32_t _zcseq;
+                retired_type _retired;
+                bool _active;
 
                 void _init_buf_ptrs();
                 int _send(const buffer_type& buf);
-                void _resizewbuf(const buffer_type& buf, void *iov_base=nullptr, std::size_t buflen=0);
-                void _memmoverbuf();
+                void _appendwbuf(const buffer_type& buf);
+                void _freewbuf(const buffer_type& buf, std::size_t n);
+                bool _zcinit();
+                std::size_t _sendlen(const buffer_type& buf) const;
+                void _resizerbuf(std::size_t size);
                 int _recv();
         };
     }
@@ -17,7 +17,11 @@
 #include "streams.hpp"
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <linux/io_uring.h>
 
 #pragma once
 #ifndef IO
@@ -55,6 +59,24 @@ namespace io {
         }
     };
 
+    /* epoll_t reports events using the same pollfd layout as *
+     * poll_t so that an epoll backed poller can be swapped in *
+     * behind the same trigger and handler types at runtime.  */
+    struct epoll_t : public poll_t {
+        using epoll_event_type = struct epoll_event;
+        using epoll_events_type = std::vector<epoll_event_type>;
+    };
+
+    /* uring_t drives readiness through io_uring poll requests *
+     * and completions, it also reports events in the pollfd   *
+     * layout of poll_t.                                       */
+    struct uring_t : public poll_t {
+        using sqe_type = struct io_uring_sqe;
+        using cqe_type = struct io_uring_cqe;
+        using buf_ring_type = struct io_uring_buf_ring;
+        using user_data_type = std::uint64_t;
+    };
+
     template<class PollT>
     struct poll_traits : public PollT
     {
@@ -65,6 +87,75 @@ namespace io {
         static const size_type npos = -1;
     };
 
+    template<>
+    struct poll_traits<epoll_t> : public epoll_t
+    {
+        using Base = epoll_t;
+        using signal_type = sigset_t;
+        using size_type = std::size_t;
+        using duration_type = std::chrono::milliseconds;
+        static const size_type npos = -1;
+        static constexpr size_type MIN_EVENTS = 64;
+        static constexpr size_type MAX_EVENTS = 4096;
+
+        static std::uint32_t to_native(const event_mask& events){
+            std::uint32_t native = 0;
+            if(events & POLLIN) native |= EPOLLIN;
+            if(events & POLLPRI) native |= EPOLLPRI;
+            if(events & POLLOUT) native |= EPOLLOUT;
+            if(events & POLLRDHUP) native |= EPOLLRDHUP;
+            return native;
+        }
+        static event_mask from_native(const std::uint32_t& native){
+            event_mask events = 0;
+            if(native & EPOLLIN) events |= POLLIN;
+            if(native & EPOLLPRI) events |= POLLPRI;
+            if(native & EPOLLOUT) events |= POLLOUT;
+            if(native & EPOLLRDHUP) events |= POLLRDHUP;
+            if(native & EPOLLERR) events |= POLLERR;
+            if(native & EPOLLHUP) events |= POLLHUP;
+            return events;
+        }
+    };
+
+    template<>
+    struct poll_traits<uring_t> : public uring_t
+    {
+        using Base = uring_t;
+        using signal_type = sigset_t;
+        using size_type = std::size_t;
+        using duration_type = std::chrono::milliseconds;
+        static const size_type npos = -1;
+        static constexpr unsigned ENTRIES = 256;
+        /* completions of cancels and closes are dropped. */
+        static constexpr user_data_type CANCEL = UINT64_MAX;
+        /* Receives land in NBUFS provided buffers of BUFSIZE bytes *
+         * that are shared by every stream on the ring, a stream    *
+         * stops receiving once MAX_QUEUED bytes are waiting on it. *
+         * Up to MAX_SEND bytes queue behind the send in flight.    */
+        static constexpr unsigned NBUFS = 128;
+        static constexpr std::size_t BUFSIZE = 8*1024;
+        static constexpr std::uint16_t BGID = 0;
+        static constexpr std::size_t MAX_QUEUED = 16*BUFSIZE;
+        static constexpr std::size_t MAX_SEND = 64*1024;
+        enum ops {POLL, ACCEPT, RECV, SEND, SHUTDOWN};
+
+        static user_data_type make_user_data(const native_handle_type& handle, const std::uint16_t& gen, const int& op = POLL){
+            return (static_cast<user_data_type>(op) << 48) |
+                (static_cast<user_data_type>(gen) << 32) |
+                static_cast<std::uint32_t>(handle);
+        }
+        static native_handle_type handle_of(const user_data_type& data){
+            return static_cast<native_handle_type>(data & UINT32_MAX);
+        }
+        static std::uint16_t gen_of(const user_data_type& data){
+            return static_cast<std::uint16_t>(data >> 32);
+        }
+        static int op_of(const user_data_type& data){
+            return static_cast<int>((data >> 48) & UINT8_MAX);
+        }
+    };
+
     template<class PollT, class Traits = poll_traits<PollT> >
     class basic_poller {
         public:
@@ -129,6 +220,186 @@ namespace io {
             size_type _poll(const duration_type& timeout) override;
     };
 
+    /* epoller keeps its interest set in the kernel and only   *
+     * ever fills events() with the descriptors that are ready *
+     * (sorted by descriptor), so the cost of a wakeup scales  *
+     * with the number of ready events rather than the number  *
+     * of registered descriptors.                              */
+    class epoller: public basic_poller<poll_t> {
+        public:
+            using Base = basic_poller<poll_t>;
+            using traits_type = poll_traits<epoll_t>;
+            using size_type = Base::size_type;
+            using duration_type = Base::duration_type;
+            using event_type = Base::event_type;
+            using events_type = Base::events_type;
+            using event_mask = Base::event_mask;
+            using epoll_events_type = traits_type::epoll_events_type;
+
+            epoller();
+            virtual ~epoller();
+
+            epoller(const epoller& other) = delete;
+            epoller(epoller&& other) = delete;
+            epoller& operator=(const epoller& other) = delete;
+            epoller& operator=(epoller&& other) = delete;
+
+        protected:
+            size_type _add(native_handle_type handle, events_type& events, event_type event) override;
+            size_type _update(native_handle_type handle, events_type& events, event_type event) override;
+            size_type _del(native_handle_type handle, events_type& events ) override;
+            size_type _poll(const duration_type& timeout) override;
+
+        private:
+            int _epfd;
+            size_type _nfds;
+            epoll_events_type _ready;
+    };
+
+    /* uring_poller arms one-shot io_uring poll requests and re- *
+     * arms them after they fire, which keeps the level-triggered *
+     * semantics the handlers rely on. Interest changes are only  *
+     * queued on the submission ring, they are submitted together *
+     * with the wait in a single io_uring_enter() per wakeup.     *
+     *                                                            *
+     * The first uring_poller to poll on a thread also takes over *
+     * the socket I/O of the sockbufs on that thread. Listeners   *
+     * accept with a multishot accept, streams receive with a     *
+     * multishot receive into the provided buffers, and writes    *
+     * are queued as sends that go out with the next wait. The    *
+     * readiness of these sockets is derived from the queued      *
+     * completions instead of from poll requests.                 */
+    class uring_poller: public basic_poller<poll_t> {
+        public:
+            using Base = basic_poller<poll_t>;
+            using traits_type = poll_traits<uring_t>;
+            using size_type = Base::size_type;
+            using duration_type = Base::duration_type;
+            using event_type = Base::event_type;
+            using events_type = Base::events_type;
+            using event_mask = Base::event_mask;
+            using sqe_type = traits_type::sqe_type;
+            using cqe_type = traits_type::cqe_type;
+            using user_data_type = traits_type::user_data_type;
+
+            using buf_ring_type = traits_type::buf_ring_type;
+
+            uring_poller();
+            /* The poller that handles the socket I/O of this thread, *
+             * nullptr if there is none.                              */
+            static uring_poller *local();
+
+            /* These mirror the non-blocking socket calls, they return *
+             * -1 and set errno on failure. Sends fail with EAGAIN     *
+             * once MAX_SEND bytes are queued, and a failed send is    *
+             * reported by the calls that follow it.                   */
+            ssize_t recvmsg(native_handle_type handle, struct msghdr *msg);
+            ssize_t sendmsg(native_handle_type handle, const struct msghdr *msg);
+            native_handle_type accept(native_handle_type handle);
+            int shutdown(native_handle_type handle, int how);
+            int close(native_handle_type handle);
+            /* Blocks until there is something to receive on handle. */
+            int wait(native_handle_type handle);
+
+            virtual ~uring_poller();
+
+            uring_poller(const uring_poller& other) = delete;
+            uring_poller(uring_poller&& other) = delete;
+            uring_poller& operator=(const uring_poller& other) = delete;
+            uring_poller& operator=(uring_poller&& other) = delete;
+
+        protected:
+            size_type _add(native_handle_type handle, events_type& events, event_type event) override;
+            size_type _update(native_handle_type handle, events_type& events, event_type event) override;
+            size_type _del(native_handle_type handle, events_type& events ) override;
+            size_type _poll(const duration_type& timeout) override;
+
+        private:
+            struct interest_type {
+                event_mask events, mask;
+                std::uint16_t gen;
+                bool armed;
+            };
+            /* The completion state of a socket that the ring does I/O *
+             * for. queue holds the received buffers and the accepted  *
+             * sockets in arrival order, from head on. sendbuf is in   *
+             * flight and pending goes out once it has been sent.      */
+            struct channel_type {
+                enum kinds {NONE, STREAM, LISTENER};
+                struct segment_type {
+                    std::uint32_t value, len, offset;
+                };
+                int kind;
+                std::uint16_t gen;
+                bool receiving, capped, sending, linked, shutting, listed, eof;
+                int shut, error;
+                std::vector<segment_type> queue;
+                std::size_t head, queued;
+                std::vector<char> sendbuf, pending;
+                std::size_t sent;
+                unsigned sendsqe;
+            };
+            /* a send that was in flight when its socket was closed. */
+            struct orphan_type {
+                user_data_type user_data;
+                std::vector<char> buf;
+            };
+            using interests_type = std::vector<interest_type>;
+            using channels_type = std::vector<channel_type>;
+            using orphans_type = std::vector<orphan_type>;
+            using user_datas_type = std::vector<user_data_type>;
+            using handles_type = std::vector<native_handle_type>;
+            struct ring_type {
+                void *ptr;
+                std::size_t len;
+                unsigned *head, *tail, *mask, *entries;
+            };
+
+            int _enter(unsigned to_submit, unsigned min_complete, unsigned flags, const duration_type& timeout);
+            int _push(const sqe_type& sqe);
+            int _arm(native_handle_type handle, event_mask mask);
+            int _cancel(native_handle_type handle);
+            event_mask _mask(native_handle_type handle);
+            interest_type& _interest(native_handle_type handle);
+
+            bool _setup_buffers();
+            channel_type& _channel(native_handle_type handle);
+            channel_type *_lookup(native_handle_type handle, int kind);
+            void _attach(native_handle_type handle, int kind);
+            void _detach(native_handle_type handle);
+            void _receive(native_handle_type handle);
+            void _recycle(std::uint16_t bid);
+            int _submit_send(native_handle_type handle);
+            int _push_fd(std::uint8_t opcode, native_handle_type handle, std::uint32_t len = 0);
+            int _shutdown(native_handle_type handle, int how);
+            void _signal(native_handle_type handle);
+            void _complete(const cqe_type& cqe);
+            void _reap(events_type& events);
+            bool _collect(events_type *events);
+
+            int _fd;
+            ring_type _sq, _cq;
+            unsigned *_sq_array;
+            sqe_type *_sqes;
+            std::size_t _sqes_len;
+            cqe_type *_cqes;
+            size_type _nfds;
+            interests_type _interests;
+            handles_type _rearm;
+            /* completion based I/O, off if the kernel lacks it. */
+            bool _completions, _multishot_recv, _multishot_accept;
+            buf_ring_type *_buf_ring;
+            char *_bufs;
+            unsigned _free;
+            std::uint16_t _buf_tail;
+            channels_type _channels;
+            orphans_type _orphans;
+            /* shutdowns whose socket is closed once they complete. */
+            user_datas_type _closing;
+            handles_type _ready;
+            events_type _stash;
+    };
+
     template<class PollT, class Traits = poll_traits<PollT> >
     class basic_trigger {
         public:
@@ -142,48 +413,35 @@ namespace io {
             using events_type = typename traits_type::events_type;
             using event_mask = typename traits_type::event_mask;
             using trigger_type = std::uint32_t;
-            using interest_type = std::tuple<native_handle_type, trigger_type>;
-            using interest_list = std::vector<interest_type>;
+            /* interests are indexed directly by native handle. */
+            using interest_list = std::vector<trigger_type>;
             static const size_type npos = traits_type::npos;
 
             explicit basic_trigger(poller_type& poller): _poller{poller}{}
 
             size_type set(native_handle_type handle, trigger_type trigger) {
-                auto begin = _list.begin(), end = _list.end();
-                auto lb = std::lower_bound(
-                    begin,
-                    end,
-                    handle,
-                    [](const auto& lhs, const native_handle_type& rhs) {
-                        return std::get<native_handle_type>(lhs) < rhs;
-                    }
-                );
-                if(lb == end || std::get<native_handle_type>(*lb) != handle) {
-                    _list.insert(lb, interest_type{handle, trigger});
-                    shrink_to_fit(_list);
+                if(handle < 0)
+                    return npos;
+                const auto idx = static_cast<size_type>(handle);
+                if(idx >= _list.size())
+                    _list.resize(idx+1, 0);
+                auto& trig = _list[idx];
+                if(!trig) {
+                    trig = trigger;
                     return _poller.add(handle, traits_type::mkevent(handle, trigger));
                 }
-                auto& trig = std::get<trigger_type>(*lb);
                 if( (trig & trigger) != trigger )
                     return _poller.update(handle, traits_type::mkevent(handle, trig |= trigger));
                 return _list.size();
             }
 
             size_type clear(native_handle_type handle, trigger_type trigger=UINT32_MAX) {
-                auto begin = _list.begin(), end = _list.end();
-                auto lb = std::lower_bound(
-                    begin,
-                    end,
-                    handle,
-                    [](const auto& lhs, const native_handle_type& rhs) {
-                        return std::get<native_handle_type>(lhs) < rhs;
-                    }
-                );
-                if(lb == end || std::get<native_handle_type>(*lb) != handle)
+                const auto idx = static_cast<size_type>(handle);
+                if(handle < 0 || idx >= _list.size() || !_list[idx])
                     return npos;
-                auto& trig = std::get<trigger_type>(*lb);
+                auto& trig = _list[idx];
                 if( !(trig & ~trigger) ) {
-                    _list.erase(lb);
+                    trig = 0;
                     return _poller.del(handle);
                 }
                 if( (trig & ~trigger) != trig )
@@ -191,6 +449,11 @@ namespace io {
                 return _list.size();
             }
 
+            trigger_type interest(native_handle_type handle) const {
+                const auto idx = static_cast<size_type>(handle);
+                return (handle < 0 || idx >= _list.size()) ? 0 : _list[idx];
+            }
+
             size_type wait(duration_type timeout = duration_type(0)){ return _poller(timeout); }
             const interest_list& list() const { return _list; }
 
@@ -214,14 +477,17 @@ namespace io {
     class trigger: public basic_trigger<poll_t> {
         public:
             using Base = basic_trigger<poll_t>;
+            using poller_type = Base::poller_type;
             using native_handle_type = Base::native_handle_type;
             using trigger_type = Base::trigger_type;
             using event_type = Base::event_type;
             using events_type = Base::events_type;
             using event_mask = Base::event_mask;
             using size_type = Base::size_type;
+            enum backends { POLL, EPOLL, URING };
 
-            trigger(): Base(_poller){}
+            explicit trigger(int backend=POLL): trigger(make_poller(backend)){}
+            int backend() const { return _backend; }
             virtual ~trigger() = default;
 
             trigger(const trigger& other) = delete;
@@ -230,7 +496,16 @@ namespace io {
             trigger& operator=(trigger&& other) = delete;
 
         private:
-            poller _poller;
+            using poller_ptr = std::tuple<std::unique_ptr<poller_type>, int>;
+            static poller_ptr make_poller(int backend);
+            explicit trigger(poller_ptr&& ptr):
+                Base(*std::get<std::unique_ptr<poller_type> >(ptr)),
+                _poller{std::move(std::get<std::unique_ptr<poller_type> >(ptr))},
+                _backend{std::get<int>(ptr)}
+            {}
+
+            std::unique_ptr<poller_type> _poller;
+            int _backend;
     };
 
     template<class TriggerT>
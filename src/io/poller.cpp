@@ -14,7 +14,22 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "io.hpp"
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
 namespace io{
+    namespace {
+        using epoll_traits = poll_traits<epoll_t>;
+        static epoll_traits::epoll_event_type make_epoll_event(const epoller::event_type& event){
+            epoll_traits::epoll_event_type ev{};
+            ev.events = epoll_traits::to_native(event.events);
+            /* Stash the fd and the interest mask in the user data so *
+             * that ready events can be reported without a lookup.    */
+            ev.data.u64 = (static_cast<std::uint64_t>(static_cast<std::uint16_t>(event.events)) << 32) |
+                static_cast<std::uint32_t>(event.fd);
+            return ev;
+        }
+    }
     poller::size_type poller::_add(
         native_handle_type handle,
         events_type& events,
@@ -86,4 +101,104 @@ namespace io{
         }
         return nfds;
     }
+
+    epoller::epoller():
+        Base(), _epfd{epoll_create1(EPOLL_CLOEXEC)},
+        _nfds{0}, _ready(traits_type::MIN_EVENTS)
+    {
+        if(_epfd < 0) {
+            throw std::system_error(
+                std::error_code(errno, std::system_category()),
+                "Unable to create epoll instance."
+            );
+        }
+    }
+
+    epoller::size_type epoller::_add(
+        native_handle_type handle,
+        events_type& events,
+        event_type event
+    ){
+        auto ev = make_epoll_event(event);
+        if(epoll_ctl(_epfd, EPOLL_CTL_ADD, handle, &ev)) {
+            /* The handle was recycled before it was cleared. */
+            if(errno != EEXIST || epoll_ctl(_epfd, EPOLL_CTL_MOD, handle, &ev))
+                return npos;
+            return _nfds;
+        }
+        return ++_nfds;
+    }
+
+    epoller::size_type epoller::_update(
+        native_handle_type handle,
+        events_type& events,
+        event_type event
+    ){
+        auto ev = make_epoll_event(event);
+        if(epoll_ctl(_epfd, EPOLL_CTL_MOD, handle, &ev)) {
+            /* Closing a descriptor removes it from the epoll set. */
+            if(errno != ENOENT || epoll_ctl(_epfd, EPOLL_CTL_ADD, handle, &ev))
+                return npos;
+        }
+        return _nfds;
+    }
+
+    epoller::size_type epoller::_del(native_handle_type handle, events_type& events) {
+        if(_nfds)
+            --_nfds;
+        if(epoll_ctl(_epfd, EPOLL_CTL_DEL, handle, nullptr))
+            return npos;
+        return _nfds;
+    }
+
+    epoller::size_type epoller::_poll(const duration_type& timeout)
+    {
+        int nfds = 0;
+        events().clear();
+        if( (nfds=epoll_wait(_epfd, _ready.data(), _ready.size(), timeout.count())) < 0 )
+        {
+            switch(errno)
+            {
+                case EINTR:
+                    return 0;
+                default:
+                    return npos;
+            }
+        }
+        events().reserve(nfds);
+        for(int i=0; i < nfds; ++i) {
+            const auto& ev = _ready[i];
+            events().push_back(traits_type::mkevent(
+                static_cast<native_handle_type>(ev.data.u64 & UINT32_MAX),
+                static_cast<event_mask>(ev.data.u64 >> 32),
+                traits_type::from_native(ev.events)
+            ));
+        }
+        std::sort(events().begin(), events().end(),
+            [](const auto& lhs, const auto& rhs) {
+                return lhs.fd < rhs.fd;
+            }
+        );
+        if(static_cast<size_type>(nfds) == _ready.size() && _ready.size() < traits_type::MAX_EVENTS)
+            _ready.resize(2*_ready.size());
+        return nfds;
+    }
+
+    epoller::~epoller() {
+        if(_epfd > -1)
+            close(_epfd);
+    }
+
+    trigger::poller_ptr trigger::make_poller(int backend) {
+        switch(backend) {
+            case POLL:
+                return poller_ptr{std::make_unique<poller>(), backend};
+            case EPOLL:
+                return poller_ptr{std::make_unique<epoller>(), backend};
+            case URING:
+                return poller_ptr{std::make_unique<uring_poller>(), backend};
+            default:
+                throw std::invalid_argument("Unsupported poller backend.");
+        }
+    }
 }
@@ -0,0 +1,118 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "pool.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+namespace io{
+    namespace buffers{
+        namespace {
+            /* set once this thread's pool is destroyed, late frees *
+             * from other thread_local destructors go to the heap.   */
+            static thread_local bool finalized = false;
+            static constexpr std::size_t npos = -1;
+            static std::size_t size_class(std::size_t size){
+                std::size_t idx = 0;
+                for(std::size_t csize = pool::MIN_CLASS; csize < size; csize <<= 1)
+                    if(++idx == pool::NUM_CLASSES)
+                        return npos;
+                return idx;
+            }
+            static void increment(std::atomic<std::size_t>& counter){
+                /* only the owning thread writes its counters. */
+                counter.store(counter.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+            }
+        }
+        pool::pool():
+            _classes{}, _stats{}
+        {}
+        pool *pool::local() noexcept {
+            if(finalized)
+                return nullptr;
+            static thread_local pool p;
+            return &p;
+        }
+        void *pool::allocate(size_type size){
+            const auto idx = size_class(size);
+            auto *p = local();
+            if(p && idx != npos) {
+                auto& list = p->_classes[idx];
+                if(auto *blk = list.head) {
+                    list.head = blk->next;
+                    --list.count;
+                    increment(p->_stats.hits);
+                    return blk;
+                }
+            }
+            if(p)
+                increment(p->_stats.misses);
+            void *ptr = std::malloc(idx != npos ? MIN_CLASS << idx : size);
+            if(!ptr)
+                throw std::bad_alloc();
+            return ptr;
+        }
+        void pool::deallocate(void *ptr, size_type size) noexcept {
+            if(!ptr)
+                return;
+            const auto idx = size_class(size);
+            auto *p = local();
+            if(p && idx != npos) {
+                auto& list = p->_classes[idx];
+                if(list.count < std::max<size_type>(CACHE_SIZE/(MIN_CLASS << idx), 1)) {
+                    auto *blk = static_cast<block*>(ptr);
+                    blk->next = list.head;
+                    list.head = blk;
+                    ++list.count;
+                    return;
+                }
+            }
+            std::free(ptr);
+        }
+        void *pool::reallocate(void *ptr, size_type size, size_type newsize){
+            if(!ptr)
+                return allocate(newsize);
+            const auto idx = size_class(size), newidx = size_class(newsize);
+            if(idx == npos && newidx == npos) {
+                if(auto *newptr = std::realloc(ptr, newsize))
+                    return newptr;
+                throw std::bad_alloc();
+            }
+            if(idx == newidx)
+                return ptr;
+            void *newptr = allocate(newsize);
+            std::memcpy(newptr, ptr, std::min(size, newsize));
+            deallocate(ptr, size);
+            return newptr;
+        }
+        const pool::stats_type& pool::stats(){
+            static const stats_type empty{};
+            if(auto *p = local())
+                return p->_stats;
+            return empty;
+        }
+        pool::~pool(){
+            finalized = true;
+            for(auto& list: _classes) {
+                while(auto *blk = list.head) {
+                    list.head = blk->next;
+                    std::free(blk);
+                }
+                list.count = 0;
+            }
+        }
+    }
+}
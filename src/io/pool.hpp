@@ -0,0 +1,84 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#pragma once
+#ifndef IO_POOL
+#define IO_POOL
+namespace io{
+    namespace buffers{
+        /* Per-thread cache of fixed size blocks. Sizes are rounded up *
+         * to a power of two size class, blocks are plain heap memory  *
+         * so they can be released on any thread without locking.     */
+        class pool {
+            public:
+                using size_type = std::size_t;
+                static constexpr size_type MIN_CLASS = 256;
+                static constexpr size_type MAX_CLASS = 64*1024;
+                static constexpr size_type NUM_CLASSES = 9;
+                static constexpr size_type CACHE_SIZE = 2*1024*1024; /* bytes per class. */
+
+                struct stats_type {
+                    std::atomic<size_type> hits, misses;
+                };
+
+                static void *allocate(size_type size);
+                static void deallocate(void *ptr, size_type size) noexcept;
+                static void *reallocate(void *ptr, size_type size, size_type newsize);
+                static const stats_type& stats();
+
+                pool(const pool& other) = delete;
+                pool& operator=(const pool& other) = delete;
+                pool(pool&& other) = delete;
+                pool& operator=(pool&& other) = delete;
+
+            private:
+                struct block {
+                    block *next;
+                };
+                struct freelist {
+                    block *head;
+                    size_type count;
+                };
+
+                std::array<freelist, NUM_CLASSES> _classes;
+                stats_type _stats;
+
+                pool();
+                static pool *local() noexcept;
+                ~pool();
+        };
+        template<class T>
+        struct pool_allocator {
+            using value_type = T;
+
+            pool_allocator() noexcept = default;
+            template<class U>
+            pool_allocator(const pool_allocator<U>& other) noexcept {}
+
+            T *allocate(std::size_t n) { return static_cast<T*>(pool::allocate(n*sizeof(T))); }
+            void deallocate(T *ptr, std::size_t n) noexcept { pool::deallocate(ptr, n*sizeof(T)); }
+
+            template<class U>
+            bool operator==(const pool_allocator<U>& other) const noexcept { return true; }
+            template<class U>
+            bool operator!=(const pool_allocator<U>& other) const noexcept { return false; }
+        };
+    }
+}
+#endif
@@ -14,14 +14,21 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "buffers.hpp"
+#include "io.hpp"
+#include "pool.hpp"
+#include "../trace.hpp"
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <cstdint>
+#include <climits>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <unistd.h>
@@ -49,49 +56,44 @@ namespace io{
         }
         void sockbuf::_init_buf_ptrs(){
             for(std::size_t i=0; i < 2; ++i)
-                _buffers.push_back(std::make_shared<socket_message>());
+                _buffers.push_back(std::allocate_shared<socket_message>(pool_allocator<socket_message>()));
             if(_which & std::ios_base::in){
                 auto& buf = _buffers[0];
                 auto&[from, len] = buf->addr;
                 len = sizeof(from);
                 std::memset(&from, 0, sizeof(from));
-                auto& recvbuf_ = buf->data;
-                if( !(recvbuf_.iov_base = std::malloc(MIN_BUFSIZE)) )
-                    throw std::bad_alloc();
-                recvbuf_.iov_len = MIN_BUFSIZE;
-                char *data = reinterpret_cast<char*>(recvbuf_.iov_base);
-                setg(data, data, data);
             }
             if(_which & std::ios_base::out){
                 auto& buf = _buffers[1];
                 auto&[to, len] = buf->addr;
                 std::memset(&to, 0, sizeof(to));
                 len = 0;
-                auto& sendbuf_ = buf->data;
-                if( !(sendbuf_.iov_base = std::malloc(MIN_BUFSIZE)) )
-                    throw std::bad_alloc();
-                sendbuf_.iov_len = MIN_BUFSIZE;
-                char *data = reinterpret_cast<char*>(sendbuf_.iov_base);
-                setp(data, data+MIN_BUFSIZE);
             }
+            /* buffers are allocated on the first read or write. */
+            setg(nullptr, nullptr, nullptr);
+            setp(nullptr, nullptr);
         }
         sockbuf::sockbuf():
             Base(),
             _buffers{}, _socket{BAD_SOCKET},
             _errno{0}, _connected{false},
-            _which{std::ios_base::in | std::ios_base::out}
+            _which{std::ios_base::in | std::ios_base::out},
+            _budget{RECV_BUDGET}, _zerocopy{0},
+            _zcenabled{false}, _zcseq{0}, _active{false}
             { _init_buf_ptrs(); }
 
         sockbuf::sockbuf(native_handle_type sockfd, bool connected, std::ios_base::openmode which):
             Base(), _buffers{},
             _socket{sockfd}, _errno{0}, _connected{connected},
-            _which{which}
+            _which{which}, _budget{RECV_BUDGET}, _zerocopy{0},
+            _zcenabled{false}, _zcseq{0}, _active{false}
         { _init_buf_ptrs(); }
 
         sockbuf::sockbuf(int domain, int type, int protocol, std::ios_base::openmode which):
             Base(), _buffers{},
             _socket{BAD_SOCKET}, _errno{0}, _connected{false},
-            _which{which}
+            _which{which}, _budget{RECV_BUDGET}, _zerocopy{0},
+            _zcenabled{false}, _zcseq{0}, _active{false}
         {
             if((_socket = socket(domain, type, protocol)) < 0)
                 throw_system_error("Unable to open new socket.");
@@ -100,15 +102,11 @@ namespace io{
         sockbuf::buffer_type sockbuf::connectto(const struct sockaddr *addr, socklen_t addrlen){
             auto& addr_ = std::get<struct sockaddr_storage>(_buffers.back()->addr);
             if(addr_.ss_family != AF_UNSPEC){
-                auto& piov = _buffers.back()->data;
-                piov.iov_len = pptr()-pbase();
-                _buffers.push_back(std::make_shared<socket_message>());
-                auto& sendbuf_ = _buffers.back()->data;
-                if( !(sendbuf_.iov_base = std::malloc(MIN_BUFSIZE)) )
-                    throw std::bad_alloc();
-                sendbuf_.iov_len = MIN_BUFSIZE;
-                char *data = reinterpret_cast<char*>(sendbuf_.iov_base);
-                setp(data, data+MIN_BUFSIZE);
+                auto& segments = _buffers.back()->segments;
+                if(!segments.empty())
+                    segments.back().iov_len = pptr()-pbase();
+                _buffers.push_back(std::allocate_shared<socket_message>(pool_allocator<socket_message>()));
+                setp(nullptr, nullptr);
             }
             auto&[address, len] = _buffers.back()->addr;
             len = addrlen;
@@ -148,7 +146,7 @@ namespace io{
                                 return Base::seekoff(off, dir, which);
                         }
                     } else if(which & std::ios_base::out)
-                        pos = pptr()-pbase();
+                        pos = _sendlen(_buffers.back());
                     return seekpos(pos+off, which);
                 default:
                     return Base::seekoff(off,dir,which);
@@ -158,10 +156,21 @@ namespace io{
             if(pos < 0)
                 return Base::seekpos(pos, which);
             if(which & std::ios_base::out){
-                if(pos > pptr()-pbase())
+                auto& buf = _buffers.back();
+                auto& segments = buf->segments;
+                if(segments.empty() && pos == 0)
+                    return pos;
+                if(segments.empty() || pos > static_cast<off_type>(_sendlen(buf)))
                     return Base::seekpos(pos, which);
-                setp(pbase(), epptr());
-                pbump(pos);
+                off_type head = static_cast<off_type>(MIN_BUFSIZE*(segments.size()-1)) -
+                        static_cast<off_type>(buf->offset);
+                for(; pos < head; head -= MIN_BUFSIZE) {
+                    pool::deallocate(segments.back().iov_base, MIN_BUFSIZE);
+                    segments.pop_back();
+                }
+                char *data = static_cast<char*>(segments.back().iov_base);
+                setp(data, data+MIN_BUFSIZE);
+                pbump(pos-head);
             } else if(which & std::ios_base::in){
                 if(pos > egptr()-eback())
                     return Base::seekpos(pos, which);
@@ -169,36 +178,92 @@ namespace io{
             } else return Base::seekpos(pos, which);
             return pos;
         }
-        void sockbuf::_resizewbuf(const buffer_type& buf, void *base, std::size_t buflen){
-            auto& sendbuf_ = buf->data;
-            if(base){
-                if(buflen)
-                    std::memmove(sendbuf_.iov_base, base, buflen);
-                if(buf==_buffers.back()){
-                    setp(pbase(), epptr());
-                    pbump(buflen);
-                }
+        void sockbuf::_appendwbuf(const buffer_type& buf){
+            auto& segments = buf->segments;
+            if(!segments.empty() && buf == _buffers.back())
+                segments.back().iov_len = pptr()-pbase();
+            void *ptr = pool::allocate(MIN_BUFSIZE);
+            segments.push_back(socket_message::data_buffer{ptr, 0});
+            char *data = static_cast<char*>(ptr);
+            setp(data, data+MIN_BUFSIZE);
+        }
+        void sockbuf::_freewbuf(const buffer_type& buf, std::size_t n){
+            /* Segments that an in-flight MSG_ZEROCOPY send still *
+             * references are retired until reap() sees them acked. */
+            auto& segments = buf->segments;
+            for(std::size_t i=0; i < n; ++i){
+                if(i < buf->zcsegs)
+                    _retired.emplace_back(buf->zcseq, segments[i].iov_base);
+                else pool::deallocate(segments[i].iov_base, MIN_BUFSIZE);
             }
-            if(buf==_buffers.back()){
-                std::streamsize putlen = pptr()-pbase();
-                if(std::size_t size=MIN_BUFSIZE*(putlen/MIN_BUFSIZE+1);
-                        sendbuf_.iov_len != size)
-                {
-                    if(auto *ptr = std::realloc(sendbuf_.iov_base, size))
-                        sendbuf_.iov_base = ptr;
-                    else throw std::bad_alloc();
-                    char *data = reinterpret_cast<char*>(sendbuf_.iov_base);
-                    setp(data, data+size);
-                    pbump(putlen);
-                    sendbuf_.iov_len=size;
+            buf->zcsegs -= std::min(buf->zcsegs, n);
+            segments.erase(segments.begin(), segments.begin()+n);
+        }
+        bool sockbuf::_zcinit(){
+            if(_zcenabled)
+                return true;
+            int on = 1;
+            if(setsockopt(_socket, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on))){
+                /* not supported by this socket, always copy. */
+                _zerocopy = 0;
+                return false;
+            }
+            return (_zcenabled = true);
+        }
+        int sockbuf::reap(){
+            if(!_zcenabled)
+                return 0;
+            int reaped = 0;
+            std::array<char, CMSG_SPACE(sizeof(struct sock_extended_err)+sizeof(struct sockaddr_in6))> control;
+            struct msghdr msg = {};
+            while(true){
+                msg.msg_control = control.data();
+                msg.msg_controllen = control.size();
+                if(recvmsg(_socket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0){
+                    switch(errno){
+                        case EINTR: continue;
+                        case EAGAIN: return reaped;
+                        default: return -1;
+                    }
+                }
+                for(auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)){
+                    if( !(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+                        !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)
+                    ){
+                        continue;
+                    }
+                    struct sock_extended_err err = {};
+                    std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+                    if(err.ee_errno || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                        continue;
+                    /* sends ee_info through ee_data have completed. */
+                    const std::uint32_t lo = err.ee_info, hi = err.ee_data;
+                    auto it = std::remove_if(_retired.begin(), _retired.end(), [&](auto& retired){
+                        auto&[seq, ptr] = retired;
+                        if(static_cast<std::uint32_t>(seq-lo) > static_cast<std::uint32_t>(hi-lo))
+                            return false;
+                        pool::deallocate(ptr, MIN_BUFSIZE);
+                        return true;
+                    });
+                    _retired.erase(it, _retired.end());
+                    ++reaped;
                 }
             }
         }
+        std::size_t sockbuf::_sendlen(const buffer_type& buf) const {
+            const auto& segments = buf->segments;
+            if(segments.empty())
+                return 0;
+            /* every segment but the last one is full. */
+            std::size_t tail = (buf == _buffers.back()) ?
+                    pptr()-pbase() :
+                    segments.back().iov_len;
+            return MIN_BUFSIZE*(segments.size()-1) + tail - buf->offset;
+        }
         int sockbuf::_send(const buffer_type& buf){
-            auto& header = buf->header;
+            struct msghdr header = {};
             auto&[address, addrlen] = buf->addr;
             if( (_socket == BAD_SOCKET) || (!_connected && address.ss_family == AF_UNSPEC) ){
-                _resizewbuf(buf);
                 return 0;
             } else if(_connected ||
                 /* This next line is so that we can take advantage of *
@@ -213,17 +278,11 @@ namespace io{
                 header.msg_name = &address;
                 header.msg_namelen = addrlen;
             }
-            auto& sendbuf_ = buf->data;
-            void *data = sendbuf_.iov_base, *base = nullptr;
-            std::size_t iov_len = sendbuf_.iov_len;
-            std::size_t buflen = (buf==_buffers.back()) ? pptr()-pbase() : iov_len;
-            if(buflen){
-                header.msg_iov = &sendbuf_;
-                header.msg_iovlen = 1;
-            } else {
-                header.msg_iov = nullptr;
-                header.msg_iovlen = 0;
-            }
+            auto& segments = buf->segments;
+            auto& offset = buf->offset;
+            std::size_t buflen = _sendlen(buf);
+            if(!segments.empty() && buf == _buffers.back())
+                segments.back().iov_len = pptr()-pbase();
             auto& cbuf = buf->ancillary;
             if(cbuf.empty()){
                 header.msg_control = nullptr;
@@ -232,38 +291,117 @@ namespace io{
                 header.msg_control = cbuf.data();
                 header.msg_controllen = 0;
             }
-            if(!buflen && cbuf.empty())
+            /* The ring copies what it sends, and it reports a failed *
+             * send on the next call, even one with nothing to send.  */
+            auto *ring = (_connected && cbuf.empty()) ? uring_poller::local() : nullptr;
+            if(!buflen && cbuf.empty() && !ring)
                 return 0;
-            sendbuf_.iov_len = std::min(buflen, MIN_BUFSIZE);
+            int flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+            if(!ring && _zerocopy && buflen >= _zerocopy && _zcinit())
+                flags |= MSG_ZEROCOPY;
+            std::size_t first = 0;
             ssize_t len = 0;
-            while( !(_errno=0) && (len=sendmsg(_socket, &header, MSG_DONTWAIT | MSG_NOSIGNAL)) ){
+            while(!(_errno=0)) {
+                /* The whole backlog goes out in one sendmsg(), the *
+                 * first segment is trimmed to its unsent bytes.    */
+                struct iovec *iov = nullptr;
+                if(buflen) {
+                    iov = &segments[first];
+                    iov->iov_base = static_cast<char*>(iov->iov_base)+offset;
+                    iov->iov_len -= offset;
+                    header.msg_iov = iov;
+                    header.msg_iovlen = std::min<std::size_t>(segments.size()-first, IOV_MAX);
+                } else {
+                    header.msg_iov = nullptr;
+                    header.msg_iovlen = 0;
+                }
+                len = ring ?
+                        ring->sendmsg(_socket, &header) :
+                        sendmsg(_socket, &header, flags);
+                if(iov) {
+                    iov->iov_base = static_cast<char*>(iov->iov_base)-offset;
+                    iov->iov_len += offset;
+                }
                 if(len > 0) {
+                    CLOUDBUS_PROBE(send, _socket, len);
+                    _active = true;
                     if(header.msg_control) {
                         header.msg_control = nullptr;
                         header.msg_controllen = 0;
                         cbuf = socket_message::ancillary_buffer();
                     }
-                    if(!(buflen-=len))
+                    buflen -= len;
+                    offset += len;
+                    while(first+1 < segments.size() && offset >= segments[first].iov_len)
+                        offset -= segments[first++].iov_len;
+                    if(flags & MSG_ZEROCOPY){
+                        /* the kernel numbers each zerocopy send in order. */
+                        buf->zcseq = _zcseq++;
+                        buf->zcsegs = std::max(buf->zcsegs, offset ? first+1 : first);
+                    }
+                    if(!buflen)
                         break;
-                    sendbuf_.iov_base = static_cast<char*>(sendbuf_.iov_base)+len;
-                    sendbuf_.iov_len = std::min(buflen, MIN_BUFSIZE);
+                } else if(!len) {
+                    break;
                 } else switch(_errno = errno) {
                     case EISCONN:
                         _connected = true;
                         header.msg_name = nullptr;
                         header.msg_namelen = 0;
                     case EINTR: continue;
+                    case ENOBUFS:
+                        /* out of optmem for notifications, copy instead. */
+                        if(flags & MSG_ZEROCOPY){
+                            flags &= ~MSG_ZEROCOPY;
+                            continue;
+                        }
                     default:
                         goto EXIT;
                 }
             }
         EXIT:
-            base = sendbuf_.iov_base;
-            sendbuf_.iov_base = data;
-            sendbuf_.iov_len = (buf==_buffers.back()) ? iov_len : buflen;
-            _resizewbuf(buf, base, buflen);
+            /* release the segments that the kernel has accepted. */
+            _freewbuf(buf, first);
+            if(!buflen && buf == _buffers.back() && !segments.empty()) {
+                offset = 0;
+                if(buf->zcsegs) {
+                    /* the tail can't be reused while the kernel reads it. */
+                    _freewbuf(buf, segments.size());
+                    _appendwbuf(buf);
+                } else {
+                    segments.back().iov_len = 0;
+                    char *data = static_cast<char*>(segments.back().iov_base);
+                    setp(data, data+MIN_BUFSIZE);
+                }
+            }
             return (!_errno || _errno==EWOULDBLOCK) ? 0 : -1;
         }
+        bool sockbuf::release(){
+            /* only streams that stayed quiet since the last call. */
+            if(_active) {
+                _active = false;
+                return false;
+            }
+            bool released = true;
+            auto& recvbuf_ = _buffers.front()->data;
+            if(recvbuf_.iov_base) {
+                if(gptr() == egptr()) {
+                    pool::deallocate(recvbuf_.iov_base, recvbuf_.iov_len);
+                    recvbuf_.iov_base = nullptr;
+                    recvbuf_.iov_len = 0;
+                    setg(nullptr, nullptr, nullptr);
+                } else released = false;
+            }
+            auto& buf = _buffers.back();
+            if(!buf->segments.empty()) {
+                if(_buffers.size() == 2 && !_sendlen(buf)) {
+                    _freewbuf(buf, buf->segments.size());
+                    buf->offset = 0;
+                    setp(nullptr, nullptr);
+                } else released = false;
+            }
+            return released;
+        }
         int sockbuf::sync() {
             auto it = ++_buffers.begin();
             while(it < _buffers.end()){
@@ -295,40 +433,58 @@ namespace io{
                             return -1;
                     }
                 }
-                if(buf->data.iov_len)
+                if(_sendlen(buf))
                     return 0;
                 if(++it != _buffers.end()){
-                    if(buf->data.iov_base){
-                        std::free(buf->data.iov_base);
-                        buf->data.iov_base = nullptr;
-                    }
+                    _freewbuf(buf, buf->segments.size());
                     it = _buffers.erase(--it);
                 }
             }
             return 0;
         }
-        void sockbuf::_memmoverbuf(){
-            auto len = egptr()-gptr();
-            if(len)
-                std::memmove(eback(), gptr(), len);
-            setg(eback(), eback(), eback()+len);
+        void sockbuf::_resizerbuf(std::size_t size){
+            auto& recvbuf_ = _buffers.front()->data;
+            const std::size_t len = egptr()-eback();
+            recvbuf_.iov_base = pool::reallocate(recvbuf_.iov_base, recvbuf_.iov_len, size);
+            recvbuf_.iov_len = size;
+            char *data = static_cast<char*>(recvbuf_.iov_base);
+            setg(data, data, data+len);
         }
         int sockbuf::_recv(){
+            /* Bytes that do not fit in the receive buffer land in a *
+             * per-thread spill buffer, so that one recvmsg() drains *
+             * up to the receive budget from the socket.             */
+            static thread_local std::vector<char> spill;
             if(_socket == BAD_SOCKET)
                 return -1;
-            _memmoverbuf();
+            /* The get area is only refilled once it has been drained, *
+             * so pending bytes are never moved to make room.          */
+            if(gptr() != egptr())
+                return 0;
+            if(auto& data = _buffers.front()->data; !data.iov_base && (_which & std::ios_base::in)) {
+                data.iov_base = pool::allocate(MIN_BUFSIZE);
+                data.iov_len = MIN_BUFSIZE;
+                char *base = static_cast<char*>(data.iov_base);
+                setg(base, base, base);
+            }
+            setg(eback(), eback(), eback());
             auto& buf = _buffers.front();
-            auto& header = buf->header;
+            struct msghdr header = {};
             auto&[address, addrlen] = buf->addr;
             header.msg_name = &address;
             header.msg_namelen = addrlen;
             auto& recvbuf_ = buf->data;
-            void *data = recvbuf_.iov_base;
-            std::size_t iov_len = recvbuf_.iov_len;
-            std::size_t buflen = iov_len-(egptr()-eback());
-            if(buflen){
-                header.msg_iov = &recvbuf_;
-                header.msg_iovlen = 1;
+            std::size_t buflen = recvbuf_.iov_len-(egptr()-eback());
+            std::size_t spillen = (recvbuf_.iov_base && _budget > buflen) ? _budget-buflen : 0;
+            if(spill.size() < spillen)
+                spill.resize(spillen);
+            std::array<struct iovec, 2> iov = {{
+                {egptr(), buflen},
+                {spill.data(), spillen}
+            }};
+            if(buflen || spillen){
+                header.msg_iov = iov.data();
+                header.msg_iovlen = spillen ? 2 : 1;
             } else {
                 header.msg_iov = nullptr;
                 header.msg_iovlen = 0;
@@ -341,12 +497,11 @@ namespace io{
                 header.msg_control = cbuf.data();
                 header.msg_controllen = cbuf.size();
             }
-            if(!buflen && cbuf.empty())
+            if(!buflen && !spillen && cbuf.empty())
                 return 0;
-            recvbuf_.iov_base = egptr();
-            recvbuf_.iov_len = buflen;
+            auto *ring = (_connected && cbuf.empty()) ? uring_poller::local() : nullptr;
             ssize_t len = 0;
-            while( !(_errno=0) && (len = recvmsg(_socket, &header, MSG_DONTWAIT)) ){
+            while( !(_errno=0) && (len = ring ? ring->recvmsg(_socket, &header) : recvmsg(_socket, &header, MSG_DONTWAIT)) ){
                 if(len < 0){
                     switch(_errno = errno){
                         case EINTR:
@@ -355,12 +510,17 @@ namespace io{
                             goto EXIT;
                     }
                 }
+                if(static_cast<std::size_t>(len) > buflen){
+                    const std::size_t size = egptr()-eback()+len;
+                    _resizerbuf(MIN_BUFSIZE*(size/MIN_BUFSIZE+1));
+                    std::memcpy(egptr()+buflen, spill.data(), len-buflen);
+                }
                 setg(eback(), gptr(), egptr()+len);
+                CLOUDBUS_PROBE(recv, _socket, len);
+                _active = true;
                 break;
             }
         EXIT:
-            recvbuf_.iov_base = data;
-            recvbuf_.iov_len = iov_len;
             /* end-of-file */
             if(!len && !header.msg_control)
                 return -1;
@@ -368,36 +528,65 @@ namespace io{
                 return -1;
             return 0;
         }
+        int sockbuf::shutdown(int how){
+            if(auto *ring = uring_poller::local())
+                return ring->shutdown(_socket, how);
+            return ::shutdown(_socket, how);
+        }
+        sockbuf::native_handle_type sockbuf::accept(){
+            if(auto *ring = uring_poller::local())
+                return ring->accept(_socket);
+            return accept4(_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        }
         std::streamsize sockbuf::showmanyc() {
             if(egptr()==gptr() && _recv())
                 return -1;
             return egptr()-gptr();
         }
         sockbuf::int_type sockbuf::overflow(sockbuf::int_type ch){
-            if(pbase() == nullptr || sync())
+            if(!(_which & std::ios_base::out) || sync())
                 return traits_type::eof();
+            if(pptr() == epptr())
+                _appendwbuf(_buffers.back());
             if(!traits_type::eq_int_type(ch, traits_type::eof()))
                 return sputc(ch);
             return ch;
         }
         sockbuf::int_type sockbuf::underflow() {
-            if(eback() == nullptr || _recv())
+            if(!(_which & std::ios_base::in) || _recv())
                 return traits_type::eof();
             if(egptr()-eback())
                 return traits_type::to_int_type(*gptr());
-            if(_poll(_socket, POLLIN))
+            auto *ring = _connected ? uring_poller::local() : nullptr;
+            if(ring ? ring->wait(_socket) : _poll(_socket, POLLIN))
                 return traits_type::eof();
             return underflow();
         }
         sockbuf::~sockbuf(){
+            /* Blocks that a zerocopy send may still reference can't go *
+             * back to the pool, where the next stream would overwrite  *
+             * them while the kernel reads them. They are plain heap    *
+             * memory so they are freed instead.                        */
+            reap();
             for(auto& buf: _buffers){
                 if(buf->data.iov_base){
-                    std::free(buf->data.iov_base);
+                    pool::deallocate(buf->data.iov_base, buf->data.iov_len);
                     buf->data.iov_base = nullptr;
                 }
+                for(std::size_t i=0; i < buf->segments.size(); ++i){
+                    if(i < buf->zcsegs)
+                        std::free(buf->segments[i].iov_base);
+                    else pool::deallocate(buf->segments[i].iov_base, MIN_BUFSIZE);
+                }
+                buf->segments.clear();
+            }
+            for(auto&[seq, ptr]: _retired)
+                std::free(ptr);
+            if(_socket > BAD_SOCKET) {
+                if(auto *ring = uring_poller::local())
+                    ring->close(_socket);
+                else close(_socket);
             }
-            if(_socket > BAD_SOCKET)
-                close(_socket);
         }
     }
 }
@@ -44,6 +44,13 @@ namespace io {
                 native_handle_type& native_handle() { return _buf.native_handle(); }
                 int& err() { return _buf.err(); }
                 const int& err() const { return _buf.err(); }
+                sockbuf::size_type& recvbudget() { return _buf.recvbudget(); }
+                sockbuf::size_type buffered() const { return _buf.buffered(); }
+                sockbuf::size_type& zerocopy() { return _buf.zerocopy(); }
+                int reap() { return _buf.reap(); }
+                bool release() { return _buf.release(); }
+                int shutdown(int how) { return _buf.shutdown(how); }
+                native_handle_type accept() { return _buf.accept(); }
                 sockbuf::buffer_type connectto(const struct sockaddr* addr, socklen_t len) { return _buf.connectto(addr, len); }
 
                 ~sockstream() = default;
@@ -0,0 +1,927 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "io.hpp"
+#include <algorithm>
+#include <cstring>
+#include <csignal>
+#include <system_error>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+namespace io{
+    namespace {
+        static void throw_system_error(const std::string& what){
+            throw std::system_error(
+                std::error_code(errno, std::system_category()),
+                what
+            );
+        }
+        template<class T>
+        static T *offset(void *ptr, std::size_t off){
+            return reinterpret_cast<T*>(static_cast<char*>(ptr)+off);
+        }
+        static int io_uring_setup(unsigned entries, struct io_uring_params *params){
+            return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+        }
+        static int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, void *arg, std::size_t argsz){
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz));
+        }
+        static int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args){
+            return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+        }
+        static struct io_uring_sqe cancel_sqe(std::uint64_t user_data){
+            struct io_uring_sqe sqe{};
+            sqe.opcode = IORING_OP_ASYNC_CANCEL;
+            sqe.fd = -1;
+            sqe.addr = user_data;
+            sqe.user_data = poll_traits<uring_t>::CANCEL;
+            return sqe;
+        }
+        static int poll_in(int handle){
+            struct pollfd fd = {handle, POLLIN, 0};
+            while(poll(&fd, 1, -1) < 0){
+                switch(errno){
+                    case EINTR: continue;
+                    default: return -1;
+                }
+            }
+            if(fd.revents & (POLLHUP | POLLERR | POLLNVAL))
+                return -1;
+            return 0;
+        }
+        /* the ring that does the socket I/O of this thread. */
+        static uring_poller*& local_ring(){
+            static thread_local uring_poller *ring = nullptr;
+            return ring;
+        }
+    }
+    uring_poller::uring_poller():
+        Base(), _fd{-1}, _sq{}, _cq{},
+        _sq_array{nullptr}, _sqes{nullptr}, _sqes_len{0},
+        _cqes{nullptr}, _nfds{0}, _interests{}, _rearm{},
+        _completions{false}, _multishot_recv{false}, _multishot_accept{false},
+        _buf_ring{nullptr}, _bufs{nullptr}, _free{0}, _buf_tail{0},
+        _channels{}, _orphans{}, _ready{}, _stash{}
+    {
+        struct io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+        params.cq_entries = 4*traits_type::ENTRIES;
+        if( (_fd = io_uring_setup(traits_type::ENTRIES, &params)) < 0 && errno == EINVAL ) {
+            /* kernels before 5.19 reject the task run flags. */
+            params = io_uring_params{};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = 4*traits_type::ENTRIES;
+            _fd = io_uring_setup(traits_type::ENTRIES, &params);
+        }
+        if(_fd < 0)
+            throw_system_error("Unable to set up io_uring.");
+        if( !(params.features & IORING_FEAT_EXT_ARG) ) {
+            ::close(_fd);
+            errno = ENOSYS;
+            throw_system_error("io_uring does not support timed waits.");
+        }
+        _sq.len = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+        _cq.len = params.cq_off.cqes + params.cq_entries*sizeof(cqe_type);
+        if(params.features & IORING_FEAT_SINGLE_MMAP)
+            _sq.len = _cq.len = std::max(_sq.len, _cq.len);
+        _sq.ptr = mmap(nullptr, _sq.len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+        if(_sq.ptr == MAP_FAILED) {
+            ::close(_fd);
+            throw_system_error("Unable to map the io_uring submission queue.");
+        }
+        if(params.features & IORING_FEAT_SINGLE_MMAP) {
+            _cq.ptr = _sq.ptr;
+        } else {
+            _cq.ptr = mmap(nullptr, _cq.len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+            if(_cq.ptr == MAP_FAILED) {
+                munmap(_sq.ptr, _sq.len);
+                ::close(_fd);
+                throw_system_error("Unable to map the io_uring completion queue.");
+            }
+        }
+        _sqes_len = params.sq_entries*sizeof(sqe_type);
+        void *sqes = mmap(nullptr, _sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+        if(sqes == MAP_FAILED) {
+            if(_cq.ptr != _sq.ptr)
+                munmap(_cq.ptr, _cq.len);
+            munmap(_sq.ptr, _sq.len);
+            ::close(_fd);
+            throw_system_error("Unable to map the io_uring submission entries.");
+        }
+        _sqes = static_cast<sqe_type*>(sqes);
+        _sq.head = offset<unsigned>(_sq.ptr, params.sq_off.head);
+        _sq.tail = offset<unsigned>(_sq.ptr, params.sq_off.tail);
+        _sq.mask = offset<unsigned>(_sq.ptr, params.sq_off.ring_mask);
+        _sq.entries = offset<unsigned>(_sq.ptr, params.sq_off.ring_entries);
+        _sq_array = offset<unsigned>(_sq.ptr, params.sq_off.array);
+        _cq.head = offset<unsigned>(_cq.ptr, params.cq_off.head);
+        _cq.tail = offset<unsigned>(_cq.ptr, params.cq_off.tail);
+        _cq.mask = offset<unsigned>(_cq.ptr, params.cq_off.ring_mask);
+        _cq.entries = offset<unsigned>(_cq.ptr, params.cq_off.ring_entries);
+        _cqes = offset<cqe_type>(_cq.ptr, params.cq_off.cqes);
+        /* without the socket opcodes the ring only polls. */
+        _completions = _multishot_recv = _multishot_accept = _setup_buffers();
+    }
+    bool uring_poller::_setup_buffers(){
+        constexpr unsigned NOPS = 256;
+        std::vector<char> buf(sizeof(struct io_uring_probe) + NOPS*sizeof(struct io_uring_probe_op));
+        auto *probe = reinterpret_cast<struct io_uring_probe*>(buf.data());
+        if(io_uring_register(_fd, IORING_REGISTER_PROBE, probe, NOPS))
+            return false;
+        for(const unsigned op: {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND,
+                IORING_OP_SHUTDOWN, IORING_OP_CLOSE, IORING_OP_ASYNC_CANCEL}
+        ){
+            if(op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        const std::size_t ringlen = traits_type::NBUFS*sizeof(struct io_uring_buf);
+        void *ring = mmap(nullptr, ringlen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(ring == MAP_FAILED)
+            return false;
+        void *bufs = mmap(nullptr, traits_type::NBUFS*traits_type::BUFSIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(bufs == MAP_FAILED) {
+            munmap(ring, ringlen);
+            return false;
+        }
+        struct io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<std::uint64_t>(ring);
+        reg.ring_entries = traits_type::NBUFS;
+        reg.bgid = traits_type::BGID;
+        if(io_uring_register(_fd, IORING_REGISTER_PBUF_RING, &reg, 1)) {
+            munmap(bufs, traits_type::NBUFS*traits_type::BUFSIZE);
+            munmap(ring, ringlen);
+            return false;
+        }
+        _buf_ring = static_cast<buf_ring_type*>(ring);
+        _bufs = static_cast<char*>(bufs);
+        for(unsigned bid = 0; bid < traits_type::NBUFS; ++bid)
+            _recycle(bid);
+        return true;
+    }
+    uring_poller *uring_poller::local(){
+        return local_ring();
+    }
+    int uring_poller::_enter(unsigned to_submit, unsigned min_complete, unsigned flags, const duration_type& timeout){
+        struct __kernel_timespec ts{};
+        struct io_uring_getevents_arg arg{};
+        arg.sigmask_sz = _NSIG/8;
+        if(timeout.count() >= 0) {
+            ts.tv_sec = timeout.count()/1000;
+            ts.tv_nsec = (timeout.count()%1000)*1000000;
+            arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+        }
+        int rc = 0;
+        while( (rc = io_uring_enter(_fd, to_submit, min_complete, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg))) < 0 ){
+            switch(errno) {
+                case EINTR:
+                case ETIME:
+                case EBUSY:
+                    return 0;
+                default:
+                    return -1;
+            }
+        }
+        return rc;
+    }
+    int uring_poller::_push(const sqe_type& sqe){
+        unsigned tail = *_sq.tail;
+        if(tail - __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE) >= *_sq.entries) {
+            /* The submission queue is full, flush it. */
+            if(_enter(tail - *_sq.head, 0, 0, duration_type(0)) < 0)
+                return -1;
+            if(tail - __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE) >= *_sq.entries)
+                return -1;
+        }
+        const unsigned idx = tail & *_sq.mask;
+        _sqes[idx] = sqe;
+        _sq_array[idx] = idx;
+        __atomic_store_n(_sq.tail, tail+1, __ATOMIC_RELEASE);
+        return 0;
+    }
+    int uring_poller::_push_fd(std::uint8_t opcode, native_handle_type handle, std::uint32_t len){
+        sqe_type sqe{};
+        sqe.opcode = opcode;
+        sqe.fd = handle;
+        sqe.len = len;
+        sqe.user_data = traits_type::CANCEL;
+        return _push(sqe);
+    }
+    int uring_poller::_shutdown(native_handle_type handle, int how){
+        auto& channel = _channels[handle];
+        sqe_type sqe{};
+        sqe.opcode = IORING_OP_SHUTDOWN;
+        sqe.fd = handle;
+        sqe.len = static_cast<std::uint32_t>(how);
+        sqe.user_data = traits_type::make_user_data(handle, channel.gen, traits_type::SHUTDOWN);
+        if(_push(sqe))
+            return -1;
+        channel.shutting = true;
+        return 0;
+    }
+    uring_poller::interest_type& uring_poller::_interest(native_handle_type handle){
+        const auto idx = static_cast<size_type>(handle);
+        if(idx >= _interests.size())
+            _interests.resize(idx+1, interest_type{0, 0, 0, false});
+        return _interests[idx];
+    }
+    uring_poller::event_mask uring_poller::_mask(native_handle_type handle){
+        /* Readiness that the completions already report isn't polled. */
+        event_mask mask = _interest(handle).events;
+        if(static_cast<size_type>(handle) >= _channels.size())
+            return mask;
+        const auto& channel = _channels[handle];
+        switch(channel.kind) {
+            case channel_type::STREAM:
+                mask &= ~POLLOUT;
+                if(channel.receiving || channel.eof || channel.error ||
+                        channel.head < channel.queue.size())
+                    mask &= ~POLLIN;
+                break;
+            case channel_type::LISTENER:
+                if(channel.receiving || channel.head < channel.queue.size())
+                    mask &= ~POLLIN;
+                break;
+            default:
+                break;
+        }
+        return mask;
+    }
+    int uring_poller::_arm(native_handle_type handle, event_mask mask){
+        auto& interest = _interest(handle);
+        sqe_type sqe{};
+        sqe.opcode = IORING_OP_POLL_ADD;
+        sqe.fd = handle;
+        sqe.poll32_events = static_cast<std::uint16_t>(mask);
+        sqe.user_data = traits_type::make_user_data(handle, interest.gen);
+        if(_push(sqe))
+            return -1;
+        interest.mask = mask;
+        interest.armed = true;
+        return 0;
+    }
+    int uring_poller::_cancel(native_handle_type handle){
+        auto& interest = _interest(handle);
+        if(interest.armed) {
+            sqe_type sqe{};
+            sqe.opcode = IORING_OP_POLL_REMOVE;
+            sqe.fd = -1;
+            sqe.addr = traits_type::make_user_data(handle, interest.gen);
+            sqe.user_data = traits_type::CANCEL;
+            if(_push(sqe))
+                return -1;
+            interest.armed = false;
+        }
+        /* completions for the old generation are discarded. */
+        ++interest.gen;
+        return 0;
+    }
+    uring_poller::channel_type& uring_poller::_channel(native_handle_type handle){
+        const auto idx = static_cast<size_type>(handle);
+        if(idx >= _channels.size())
+            _channels.resize(idx+1);
+        return _channels[idx];
+    }
+    uring_poller::channel_type *uring_poller::_lookup(native_handle_type handle, int kind){
+        if(!_completions || handle < 0)
+            return nullptr;
+        if(_channel(handle).kind == channel_type::NONE) {
+            /* only the sockets that this ring polls are taken over. */
+            const auto idx = static_cast<size_type>(handle);
+            if(idx >= _interests.size() || !_interests[idx].events)
+                return nullptr;
+            _attach(handle, kind);
+        }
+        auto& channel = _channels[handle];
+        return (channel.kind == kind) ? &channel : nullptr;
+    }
+    void uring_poller::_attach(native_handle_type handle, int kind){
+        if(_channel(handle).kind != channel_type::NONE)
+            _detach(handle);
+        auto& channel = _channels[handle];
+        channel.kind = kind;
+        channel.shut = -1;
+        _receive(handle);
+        /* readiness is taken over from the poll request. */
+        _rearm.push_back(handle);
+        _signal(handle);
+    }
+    void uring_poller::_detach(native_handle_type handle){
+        auto& channel = _channels[handle];
+        const int op = (channel.kind == channel_type::STREAM) ?
+                traits_type::RECV :
+                traits_type::ACCEPT;
+        if(channel.receiving)
+            _push(cancel_sqe(traits_type::make_user_data(handle, channel.gen, op)));
+        if(channel.sending) {
+            /* the send keeps its buffer until it completes. */
+            const auto user_data = traits_type::make_user_data(handle, channel.gen, traits_type::SEND);
+            _orphans.push_back(orphan_type{user_data, std::move(channel.sendbuf)});
+            _push(cancel_sqe(user_data));
+        }
+        for(auto i = channel.head; i < channel.queue.size(); ++i) {
+            const auto& segment = channel.queue[i];
+            if(channel.kind == channel_type::STREAM)
+                _recycle(static_cast<std::uint16_t>(segment.value));
+            else ::close(static_cast<native_handle_type>(segment.value));
+        }
+        const auto gen = channel.gen;
+        const bool listed = channel.listed;
+        channel = channel_type{};
+        channel.gen = gen+1;
+        channel.listed = listed;
+    }
+    void uring_poller::_receive(native_handle_type handle){
+        auto& channel = _channels[handle];
+        if(!_completions || channel.receiving)
+            return;
+        sqe_type sqe{};
+        sqe.fd = handle;
+        switch(channel.kind) {
+            case channel_type::STREAM:
+                if(!_multishot_recv || !_free || channel.eof || channel.error)
+                    return;
+                sqe.opcode = IORING_OP_RECV;
+                sqe.flags = IOSQE_BUFFER_SELECT;
+                sqe.buf_group = traits_type::BGID;
+                sqe.ioprio = IORING_RECV_MULTISHOT;
+                sqe.user_data = traits_type::make_user_data(handle, channel.gen, traits_type::RECV);
+                break;
+            case channel_type::LISTENER:
+                if(!_multishot_accept)
+                    return;
+                sqe.opcode = IORING_OP_ACCEPT;
+                sqe.ioprio = IORING_ACCEPT_MULTISHOT;
+                sqe.accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+                sqe.user_data = traits_type::make_user_data(handle, channel.gen, traits_type::ACCEPT);
+                break;
+            default:
+                return;
+        }
+        if(_push(sqe))
+            return;
+        channel.receiving = true;
+        channel.capped = false;
+        _rearm.push_back(handle);
+    }
+    void uring_poller::_recycle(std::uint16_t bid){
+        /* The uapi flexible array of bufs is misplaced in C++, where *
+         * its empty placeholder struct takes up a byte.             */
+        auto& buf = reinterpret_cast<struct io_uring_buf*>(_buf_ring)[_buf_tail & (traits_type::NBUFS-1)];
+        buf.addr = reinterpret_cast<std::uint64_t>(_bufs + bid*traits_type::BUFSIZE);
+        buf.len = traits_type::BUFSIZE;
+        buf.bid = bid;
+        __atomic_store_n(&_buf_ring->tail, ++_buf_tail, __ATOMIC_RELEASE);
+        ++_free;
+    }
+    int uring_poller::_submit_send(native_handle_type handle){
+        auto& channel = _channels[handle];
+        sqe_type sqe{};
+        sqe.opcode = IORING_OP_SEND;
+        sqe.fd = handle;
+        const bool fresh = !channel.sending;
+        if(fresh) {
+            channel.sendbuf.swap(channel.pending);
+            channel.pending.clear();
+            channel.sent = 0;
+            channel.linked = false;
+        }
+        sqe.addr = reinterpret_cast<std::uint64_t>(channel.sendbuf.data()+channel.sent);
+        sqe.len = static_cast<std::uint32_t>(channel.sendbuf.size()-channel.sent);
+        sqe.msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe.user_data = traits_type::make_user_data(handle, channel.gen, traits_type::SEND);
+        channel.sendsqe = *_sq.tail;
+        if(_push(sqe)) {
+            if(fresh)
+                channel.pending.swap(channel.sendbuf);
+            return -1;
+        }
+        channel.sending = true;
+        return 0;
+    }
+    void uring_poller::_signal(native_handle_type handle){
+        if(static_cast<size_type>(handle) >= _channels.size())
+            return;
+        auto& channel = _channels[handle];
+        if(channel.kind == channel_type::NONE || channel.listed)
+            return;
+        channel.listed = true;
+        _ready.push_back(handle);
+    }
+    ssize_t uring_poller::recvmsg(native_handle_type handle, struct msghdr *msg){
+        const bool attached = handle > -1 && static_cast<size_type>(handle) < _channels.size() &&
+                _channels[handle].kind != channel_type::NONE;
+        auto *channel = _lookup(handle, channel_type::STREAM);
+        /* A socket that is new to the ring may already hold bytes, *
+         * the receive that was just queued only sees later ones.   */
+        if(!channel || !attached)
+            return ::recvmsg(handle, msg, MSG_DONTWAIT);
+        auto& queue = channel->queue;
+        std::size_t len = 0, iov = 0, off = 0;
+        while(channel->head < queue.size() && iov < msg->msg_iovlen) {
+            auto& segment = queue[channel->head];
+            auto& dst = msg->msg_iov[iov];
+            const std::size_t n = std::min<std::size_t>(segment.len-segment.offset, dst.iov_len-off);
+            std::memcpy(static_cast<char*>(dst.iov_base)+off,
+                    _bufs + segment.value*traits_type::BUFSIZE + segment.offset, n);
+            segment.offset += n;
+            len += n;
+            if( (off += n) == dst.iov_len ) {
+                ++iov;
+                off = 0;
+            }
+            if(segment.offset == segment.len) {
+                _recycle(static_cast<std::uint16_t>(segment.value));
+                ++channel->head;
+            }
+        }
+        channel->queued -= len;
+        if(channel->head == queue.size()) {
+            queue.clear();
+            channel->head = 0;
+        }
+        if(!channel->receiving) {
+            /* resume receiving once the backlog is half drained. */
+            if(channel->queued < traits_type::MAX_QUEUED/2)
+                _receive(handle);
+            _rearm.push_back(handle);
+        }
+        msg->msg_flags = 0;
+        msg->msg_controllen = 0;
+        if(len)
+            return static_cast<ssize_t>(len);
+        if(channel->error) {
+            errno = channel->error;
+            return -1;
+        }
+        if(channel->eof)
+            return 0;
+        if(channel->receiving) {
+            errno = EAGAIN;
+            return -1;
+        }
+        return ::recvmsg(handle, msg, MSG_DONTWAIT);
+    }
+    ssize_t uring_poller::sendmsg(native_handle_type handle, const struct msghdr *msg){
+        std::size_t total = 0;
+        for(std::size_t i = 0; i < msg->msg_iovlen; ++i)
+            total += msg->msg_iov[i].iov_len;
+        if(!total) {
+            /* only reports the error of an earlier send. */
+            if(handle > -1 && static_cast<size_type>(handle) < _channels.size() &&
+                    _channels[handle].kind == channel_type::STREAM && _channels[handle].error) {
+                errno = _channels[handle].error;
+                return -1;
+            }
+            return 0;
+        }
+        auto *channel = _lookup(handle, channel_type::STREAM);
+        if(!channel)
+            return ::sendmsg(handle, msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if(channel->error) {
+            errno = channel->error;
+            return -1;
+        }
+        auto& pending = channel->pending;
+        if(pending.size() >= traits_type::MAX_SEND) {
+            errno = EAGAIN;
+            return -1;
+        }
+        std::size_t len = 0;
+        for(std::size_t i = 0; i < msg->msg_iovlen && pending.size() < traits_type::MAX_SEND; ++i) {
+            const auto& src = msg->msg_iov[i];
+            const std::size_t n = std::min(src.iov_len, traits_type::MAX_SEND-pending.size());
+            const char *data = static_cast<const char*>(src.iov_base);
+            pending.insert(pending.end(), data, data+n);
+            len += n;
+        }
+        if(!channel->sending && _submit_send(handle)) {
+            pending.resize(pending.size()-len);
+            errno = EAGAIN;
+            return -1;
+        }
+        return static_cast<ssize_t>(len);
+    }
+    uring_poller::native_handle_type uring_poller::accept(native_handle_type handle){
+        auto *channel = _lookup(handle, channel_type::LISTENER);
+        if(!channel)
+            return ::accept4(handle, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        auto& queue = channel->queue;
+        if(channel->head < queue.size()) {
+            const auto sockfd = static_cast<native_handle_type>(queue[channel->head++].value);
+            if(channel->head == queue.size()) {
+                queue.clear();
+                channel->head = 0;
+                _rearm.push_back(handle);
+            }
+            return sockfd;
+        }
+        _receive(handle);
+        if(channel->receiving) {
+            errno = EAGAIN;
+            return -1;
+        }
+        return ::accept4(handle, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    }
+    int uring_poller::shutdown(native_handle_type handle, int how){
+        if(!_completions || handle < 0 || static_cast<size_type>(handle) >= _channels.size() ||
+                _channels[handle].kind != channel_type::STREAM)
+            return ::shutdown(handle, how);
+        auto& channel = _channels[handle];
+        if(!channel.sending)
+            return _shutdown(handle, how) ? ::shutdown(handle, how) : 0;
+        /* The shutdown must not overtake the queued sends, it is   *
+         * linked to the last send if that hasn't been submitted    *
+         * yet and otherwise issued once every send has completed. */
+        channel.shut = how;
+        const unsigned tail = *_sq.tail, head = __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE);
+        if(channel.pending.empty() && channel.sendsqe+1 == tail && tail != head &&
+                tail-head < *_sq.entries) {
+            auto& sqe = _sqes[channel.sendsqe & *_sq.mask];
+            sqe.flags |= IOSQE_IO_LINK;
+            if(_shutdown(handle, how))
+                sqe.flags &= ~IOSQE_IO_LINK;
+            else channel.linked = true;
+        }
+        return 0;
+    }
+    int uring_poller::close(native_handle_type handle){
+        if(!_completions || handle < 0 || static_cast<size_type>(handle) >= _channels.size() ||
+                _channels[handle].kind == channel_type::NONE)
+            return ::close(handle);
+        if(static_cast<size_type>(handle) < _interests.size() && _interests[handle].armed)
+            _cancel(handle);
+        const bool shutting = _channels[handle].shutting;
+        const auto user_data = traits_type::make_user_data(handle, _channels[handle].gen, traits_type::SHUTDOWN);
+        _detach(handle);
+        /* A shutdown only looks up its socket once it runs in the *
+         * background, so the handle stays open until it is done   *
+         * and can't be reused by a socket of another thread.      */
+        if(shutting) {
+            _closing.push_back(user_data);
+            return 0;
+        }
+        /* the close is queued behind the cancellations. */
+        if(_push_fd(IORING_OP_CLOSE, handle))
+            return ::close(handle);
+        return 0;
+    }
+    int uring_poller::wait(native_handle_type handle){
+        while(auto *channel = _lookup(handle, channel_type::STREAM)) {
+            if(channel->head < channel->queue.size() || channel->eof || channel->error)
+                return 0;
+            _receive(handle);
+            if(!channel->receiving)
+                break;
+            const unsigned to_submit = *_sq.tail - __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE);
+            if(_enter(to_submit, 1, IORING_ENTER_GETEVENTS, duration_type(-1)) < 0)
+                return -1;
+            /* events that arrive meanwhile are kept for the next poll. */
+            _reap(_stash);
+        }
+        return poll_in(handle);
+    }
+    void uring_poller::_complete(const cqe_type& cqe){
+        const auto handle = traits_type::handle_of(cqe.user_data);
+        const auto gen = traits_type::gen_of(cqe.user_data);
+        const auto op = traits_type::op_of(cqe.user_data);
+        std::uint16_t bid = 0;
+        if(cqe.flags & IORING_CQE_F_BUFFER) {
+            bid = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            --_free;
+        }
+        if(op == traits_type::SHUTDOWN) {
+            auto it = std::find(_closing.begin(), _closing.end(), cqe.user_data);
+            if(it != _closing.end()) {
+                _closing.erase(it);
+                if(!_completions || _push_fd(IORING_OP_CLOSE, handle))
+                    ::close(handle);
+            } else if(static_cast<size_type>(handle) < _channels.size() && _channels[handle].gen == gen) {
+                _channels[handle].shutting = false;
+            }
+            return;
+        }
+        if(op == traits_type::SEND) {
+            auto it = std::find_if(_orphans.begin(), _orphans.end(),
+                [&](const auto& orphan){ return orphan.user_data == cqe.user_data; }
+            );
+            if(it != _orphans.end()) {
+                _orphans.erase(it);
+                return;
+            }
+        }
+        if(handle < 0 || static_cast<size_type>(handle) >= _channels.size() ||
+                _channels[handle].gen != gen || _channels[handle].kind == channel_type::NONE
+        ){
+            /* completions of a closed socket only return resources. */
+            if(cqe.flags & IORING_CQE_F_BUFFER)
+                _recycle(bid);
+            if(op == traits_type::ACCEPT && cqe.res >= 0)
+                ::close(cqe.res);
+            return;
+        }
+        switch(op) {
+            case traits_type::RECV:
+            {
+                auto& channel = _channels[handle];
+                if(cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER)) {
+                    channel.queue.push_back(channel_type::segment_type{bid, static_cast<std::uint32_t>(cqe.res), 0});
+                    channel.queued += cqe.res;
+                } else if(cqe.flags & IORING_CQE_F_BUFFER) {
+                    _recycle(bid);
+                }
+                if(!cqe.res) {
+                    channel.eof = true;
+                } else if(cqe.res < 0) {
+                    switch(-cqe.res) {
+                        case EINVAL:
+                            /* no multishot receive before Linux 6.0. */
+                            _multishot_recv = false;
+                        case ENOBUFS:
+                        case ECANCELED:
+                            break;
+                        default:
+                            channel.error = -cqe.res;
+                    }
+                }
+                if(!(cqe.flags & IORING_CQE_F_MORE)) {
+                    channel.receiving = channel.capped = false;
+                    _rearm.push_back(handle);
+                } else if(!channel.capped && channel.queued >= traits_type::MAX_QUEUED) {
+                    /* stop receiving until the stream catches up. */
+                    channel.capped = true;
+                    _push(cancel_sqe(cqe.user_data));
+                }
+                break;
+            }
+            case traits_type::ACCEPT:
+                if(cqe.res >= 0) {
+                    _attach(cqe.res, channel_type::STREAM);
+                    _channels[handle].queue.push_back(
+                        channel_type::segment_type{static_cast<std::uint32_t>(cqe.res), 0, 0}
+                    );
+                } else if(cqe.res == -EINVAL) {
+                    _multishot_accept = false;
+                }
+                if(!(cqe.flags & IORING_CQE_F_MORE)) {
+                    _channels[handle].receiving = false;
+                    _rearm.push_back(handle);
+                }
+                break;
+            case traits_type::SEND:
+            {
+                auto& channel = _channels[handle];
+                if(cqe.res > 0)
+                    channel.sent += cqe.res;
+                if(cqe.res < 0) {
+                    channel.error = -cqe.res;
+                } else if(!cqe.res) {
+                    channel.error = EPIPE;
+                } else if(channel.sent < channel.sendbuf.size() && _completions) {
+                    /* a short send also cancelled a linked shutdown. */
+                    channel.linked = false;
+                    if(!_submit_send(handle))
+                        return;
+                    channel.error = EIO;
+                }
+                channel.sending = false;
+                channel.sendbuf.clear();
+                if(!channel.error && !channel.pending.empty() && _completions) {
+                    if(!_submit_send(handle))
+                        break;
+                    channel.error = EIO;
+                }
+                if(channel.shut > -1 && !channel.linked && !channel.error)
+                    _shutdown(handle, channel.shut);
+                channel.shut = -1;
+                channel.linked = false;
+                break;
+            }
+            default:
+                break;
+        }
+        _signal(handle);
+    }
+    void uring_poller::_reap(events_type& events){
+        unsigned head = *_cq.head;
+        for(unsigned tail; head != (tail = __atomic_load_n(_cq.tail, __ATOMIC_ACQUIRE)); ) {
+            for(; head != tail; ++head) {
+                const cqe_type cqe = _cqes[head & *_cq.mask];
+                if(cqe.user_data == traits_type::CANCEL)
+                    continue;
+                if(traits_type::op_of(cqe.user_data) != traits_type::POLL) {
+                    _complete(cqe);
+                    continue;
+                }
+                const auto handle = traits_type::handle_of(cqe.user_data);
+                if(static_cast<size_type>(handle) >= _interests.size())
+                    continue;
+                auto& interest = _interests[handle];
+                if(interest.gen != traits_type::gen_of(cqe.user_data))
+                    continue;
+                interest.armed = false;
+                if(!interest.events)
+                    continue;
+                _rearm.push_back(handle);
+                if(cqe.res == -ECANCELED)
+                    continue;
+                const event_mask revents = (cqe.res < 0) ?
+                        POLLERR :
+                        static_cast<event_mask>(cqe.res);
+                events.push_back(traits_type::mkevent(handle, interest.events, revents));
+            }
+            __atomic_store_n(_cq.head, head, __ATOMIC_RELEASE);
+        }
+    }
+    bool uring_poller::_collect(events_type *events){
+        /* Readiness is derived from the completion state, it is   *
+         * reported for as long as it holds, like a level trigger. */
+        if(events) {
+            std::sort(_ready.begin(), _ready.end());
+            _ready.erase(std::unique(_ready.begin(), _ready.end()), _ready.end());
+        }
+        std::size_t n = 0;
+        for(const auto handle: _ready) {
+            auto& channel = _channels[handle];
+            const auto idx = static_cast<size_type>(handle);
+            const event_mask interest = (idx < _interests.size()) ? _interests[idx].events : 0;
+            event_mask revents = 0;
+            switch(channel.kind) {
+                case channel_type::STREAM:
+                    if(channel.head < channel.queue.size() || channel.eof || channel.error)
+                        revents |= POLLIN;
+                    if(channel.pending.size() < traits_type::MAX_SEND)
+                        revents |= POLLOUT;
+                    revents &= interest;
+                    if(channel.error && interest)
+                        revents |= POLLERR;
+                    break;
+                case channel_type::LISTENER:
+                    if(channel.head < channel.queue.size())
+                        revents |= POLLIN;
+                    revents &= interest;
+                    break;
+                default:
+                    break;
+            }
+            if(!events) {
+                if(revents)
+                    return true;
+                continue;
+            }
+            if(revents) {
+                events->push_back(traits_type::mkevent(handle, interest, revents));
+                _ready[n++] = handle;
+            } else channel.listed = false;
+        }
+        if(!events)
+            return false;
+        _ready.resize(n);
+        return n > 0;
+    }
+    uring_poller::size_type uring_poller::_add(
+        native_handle_type handle,
+        events_type& events,
+        event_type event
+    ){
+        if(handle < 0)
+            return npos;
+        auto& interest = _interest(handle);
+        if(interest.events || interest.armed)
+            return _update(handle, events, event);
+        interest.events = event.events;
+        _rearm.push_back(handle);
+        _signal(handle);
+        return ++_nfds;
+    }
+    uring_poller::size_type uring_poller::_update(
+        native_handle_type handle,
+        events_type& events,
+        event_type event
+    ){
+        if(handle < 0)
+            return npos;
+        /* the poll request is replaced on the next poll. */
+        _interest(handle).events = event.events;
+        _rearm.push_back(handle);
+        _signal(handle);
+        return _nfds;
+    }
+    uring_poller::size_type uring_poller::_del(native_handle_type handle, events_type& events){
+        if(handle < 0 || static_cast<size_type>(handle) >= _interests.size())
+            return npos;
+        if(_cancel(handle))
+            return npos;
+        _interests[handle].events = 0;
+        if(_nfds)
+            --_nfds;
+        return _nfds;
+    }
+    uring_poller::size_type uring_poller::_poll(const duration_type& timeout)
+    {
+        if(_completions && !local_ring())
+            local_ring() = this;
+        for(auto handle: _rearm) {
+            auto& interest = _interest(handle);
+            const auto mask = _mask(handle);
+            if(interest.armed && interest.mask == mask)
+                continue;
+            if(interest.armed && _cancel(handle))
+                return npos;
+            if(mask && _arm(handle, mask))
+                return npos;
+        }
+        _rearm.clear();
+        auto& events_ = events();
+        events_.clear();
+        events_.swap(_stash);
+        /* don't block while completions are still waiting. */
+        const bool ready = !events_.empty() || _collect(nullptr);
+        const unsigned to_submit = *_sq.tail - __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE);
+        const unsigned min_complete = (ready || !timeout.count()) ? 0 : 1;
+        if( (to_submit || !ready) &&
+                _enter(to_submit, min_complete, IORING_ENTER_GETEVENTS, ready ? duration_type(0) : timeout) < 0 )
+            return npos;
+        _reap(events_);
+        _collect(&events_);
+        std::sort(events_.begin(), events_.end(),
+            [](const auto& lhs, const auto& rhs) {
+                return lhs.fd < rhs.fd;
+            }
+        );
+        /* a handle can be both polled and completed. */
+        auto out = events_.begin();
+        for(auto it = events_.begin(); it != events_.end(); ++it) {
+            if(out != events_.begin() && (out-1)->fd == it->fd)
+                (out-1)->revents |= it->revents;
+            else *out++ = *it;
+        }
+        events_.erase(out, events_.end());
+        return events_.size();
+    }
+    uring_poller::~uring_poller(){
+        if(local_ring() == this)
+            local_ring() = nullptr;
+        if(_completions) {
+            _completions = false;
+            sqe_type sqe{};
+            sqe.opcode = IORING_OP_ASYNC_CANCEL;
+            sqe.fd = -1;
+            sqe.cancel_flags = IORING_ASYNC_CANCEL_ANY;
+            sqe.user_data = traits_type::CANCEL;
+            _push(sqe);
+            auto inflight = [&](){
+                return !_orphans.empty() || !_closing.empty() ||
+                    std::any_of(_channels.begin(), _channels.end(),
+                        [](const auto& channel){ return channel.receiving || channel.sending; });
+            };
+            /* the kernel may still write to the buffers until the *
+             * cancelled requests complete, so they are leaked if  *
+             * that takes too long.                                */
+            events_type events;
+            int tries = 0;
+            do {
+                const unsigned to_submit = *_sq.tail - __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE);
+                if(_enter(to_submit, inflight() ? 1 : 0, IORING_ENTER_GETEVENTS, duration_type(10)) < 0)
+                    break;
+                _reap(events);
+            } while(inflight() && ++tries < 100);
+            if(!inflight()) {
+                for(auto& channel: _channels) {
+                    if(channel.kind != channel_type::LISTENER)
+                        continue;
+                    for(auto i = channel.head; i < channel.queue.size(); ++i)
+                        ::close(static_cast<native_handle_type>(channel.queue[i].value));
+                }
+                struct io_uring_buf_reg reg{};
+                reg.bgid = traits_type::BGID;
+                io_uring_register(_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+                munmap(_bufs, traits_type::NBUFS*traits_type::BUFSIZE);
+                munmap(_buf_ring, traits_type::NBUFS*sizeof(struct io_uring_buf));
+            } else {
+                new channels_type(std::move(_channels));
+                new orphans_type(std::move(_orphans));
+            }
+        }
+        if(_sqes)
+            munmap(_sqes, _sqes_len);
+        if(_cq.ptr && _cq.ptr != _sq.ptr)
+            munmap(_cq.ptr, _cq.len);
+        if(_sq.ptr)
+            munmap(_sq.ptr, _sq.len);
+        if(_fd > -1)
+            ::close(_fd);
+    }
+}
@@ -14,7 +14,9 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "logging.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <ctime>
@@ -37,6 +39,149 @@ namespace cloudbus {
                 duration
             );
         }
+        /* set once this thread's ring is handed back, late logs *
+         * from other thread_local destructors are written inline. */
+        static thread_local bool finalized = false;
+        static constexpr std::chrono::milliseconds WRITE_INTERVAL{10};
+    }
+    struct Logger::ring_holder {
+        ring *r = nullptr;
+        ~ring_holder() {
+            finalized = true;
+            if(r)
+                r->claimed.store(false, std::memory_order_release);
+        }
+    };
+    Logger::Logger():
+        stop_{false}, level_{Level::WARNING}, rings_{nullptr}
+    {
+        writer_ = std::thread(&Logger::run, this);
+    }
+    Logger::~Logger() {
+        {
+            std::lock_guard<std::mutex> lk(log_mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        writer_.join();
+        auto *r = rings_.load(std::memory_order_acquire);
+        while(r) {
+            auto *next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+    Logger::ring *Logger::local_ring() {
+        if(finalized)
+            return nullptr;
+        static thread_local ring_holder holder;
+        if(holder.r)
+            return holder.r;
+        for(auto *r = rings_.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if(r->claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                return holder.r = r;
+        }
+        auto *r = new ring();
+        r->next = rings_.load(std::memory_order_relaxed);
+        while(!rings_.compare_exchange_weak(
+            r->next, r,
+            std::memory_order_release,
+            std::memory_order_relaxed
+        ));
+        return holder.r = r;
+    }
+    Logger::rate_limit::rate_limit():
+        _last{nullptr}
+    {
+        registry().push_back(this);
+    }
+    Logger::rate_limit::~rate_limit() {
+        for(auto& b: _buckets)
+            summarize(b);
+        auto& sites = registry();
+        sites.erase(std::remove(sites.begin(), sites.end(), this), sites.end());
+    }
+    std::vector<Logger::rate_limit*>& Logger::rate_limit::registry() {
+        static thread_local std::vector<rate_limit*> sites;
+        return sites;
+    }
+    Logger::rate_limit::time_point& Logger::rate_limit::due() {
+        static thread_local time_point t = time_point::max();
+        return t;
+    }
+    void Logger::rate_limit::summarize(bucket& b) {
+        /* nothing was let through to say what was suppressed. */
+        if(b.suppressed && !b.message.empty())
+            Logger::getInstance().log(b.level, std::to_string(b.suppressed) +
+                " similar messages suppressed after: " + b.message);
+        b.suppressed = 0;
+    }
+    bool Logger::rate_limit::allow(int code, std::size_t& suppressed, const time_point& now) {
+        auto it = std::find_if(
+                _buckets.begin(), _buckets.end(),
+            [&](const auto& b){
+                return b.code == code;
+            }
+        );
+        if(it == _buckets.end()) {
+            /* past MAX_CODES, unseen codes take over the oldest bucket. */
+            if(_buckets.size() < MAX_CODES) {
+                it = _buckets.insert(it, {code, BURST, 0, now, Level::DEBUG, {}});
+            } else {
+                it = std::min_element(
+                        _buckets.begin(), _buckets.end(),
+                    [](const auto& lhs, const auto& rhs){
+                        return lhs.refilled < rhs.refilled;
+                    }
+                );
+                summarize(*it);
+                *it = {code, BURST, 0, now, Level::DEBUG, {}};
+            }
+        }
+        auto& b = *it;
+        if(auto refill = static_cast<std::size_t>((now - b.refilled)/INTERVAL)) {
+            b.tokens = std::min(BURST, b.tokens + refill);
+            b.refilled += refill*INTERVAL;
+        }
+        if(!b.tokens) {
+            if(!b.suppressed++)
+                due() = std::min(due(), b.refilled + INTERVAL);
+            return false;
+        }
+        --b.tokens;
+        suppressed = b.suppressed;
+        b.suppressed = 0;
+        _last = &b;
+        return true;
+    }
+    void Logger::rate_limit::remember(Level level, const std::string& message) {
+        if(_last) {
+            _last->level = level;
+            _last->message = message;
+        }
+    }
+    void Logger::rate_limit::flush(const time_point& now) {
+        if(now < due())
+            return;
+        due() = time_point::max();
+        for(auto *site: registry()) {
+            for(auto& b: site->_buckets) {
+                if(!b.suppressed)
+                    continue;
+                if(now - b.refilled < INTERVAL) {
+                    due() = std::min(due(), b.refilled + INTERVAL);
+                    continue;
+                }
+                summarize(b);
+                const auto refill = static_cast<std::size_t>((now - b.refilled)/INTERVAL);
+                b.tokens = std::min(BURST, b.tokens + refill);
+                b.refilled += refill*INTERVAL;
+            }
+        }
+    }
+    Logger::rate_limit::time_point Logger::rate_limit::flush_due() {
+        return due();
     }
     void Logger::setLevel(Level level) {
         level_.store(level, std::memory_order_relaxed);
@@ -46,18 +191,86 @@ namespace cloudbus {
         return level_.load(std::memory_order_relaxed);
     }
     void Logger::log(Level level, const std::string_view& message) {
-        if(level <= getLevel()) {
+        if(level > getLevel())
+            return;
+        const auto now = std::chrono::system_clock::now();
+        auto *r = local_ring();
+        record tmp;
+        const auto head = r ? r->head.load(std::memory_order_relaxed) : 0;
+        if(r && head - r->tail.load(std::memory_order_acquire) >= RING_SIZE) {
+            r->drops.store(r->drops.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+            return;
+        }
+        auto& rec = r ? r->records[head % RING_SIZE] : tmp;
+        rec.time = now;
+        rec.level = level;
+        if(message.size() > RECORD_SIZE) {
+            constexpr std::string_view ellipsis = "...";
+            rec.len = RECORD_SIZE;
+            std::memcpy(rec.message.data(), message.data(), RECORD_SIZE-ellipsis.size());
+            std::memcpy(rec.message.data()+RECORD_SIZE-ellipsis.size(), ellipsis.data(), ellipsis.size());
+        } else {
+            rec.len = message.size();
+            std::memcpy(rec.message.data(), message.data(), message.size());
+        }
+        if(!r) {
             std::lock_guard<std::mutex> lk(log_mutex_);
-            *s_output_stream_.load(std::memory_order_relaxed) <<
-                "<" << static_cast<int>(level) << "> " <<
-                "<" << levelToString(level) << "> " <<
-                "<" << getCurrentTimestamp() << "> " <<
-                message << '\n';
+            return write(*s_output_stream_.load(std::memory_order_relaxed), rec);
+        }
+        r->head.store(head+1, std::memory_order_release);
+        /* wake the writer early when a ring is filling up. */
+        if(head+1 - r->tail.load(std::memory_order_relaxed) == RING_SIZE/2)
+            cv_.notify_one();
+    }
+    void Logger::write(std::ostream& os, const record& rec) {
+        os << "<" << static_cast<int>(rec.level) << "> " <<
+            "<" << levelToString(rec.level) << "> " <<
+            "<" << getCurrentTimestamp(rec.time) << "> ";
+        os.write(rec.message.data(), rec.len) << '\n';
+    }
+    bool Logger::drain(std::ostream& os) {
+        bool wrote = false;
+        for(auto *r = rings_.load(std::memory_order_acquire); r; r = r->next) {
+            auto tail = r->tail.load(std::memory_order_relaxed);
+            const auto head = r->head.load(std::memory_order_acquire);
+            for(; tail != head; ++tail, wrote = true)
+                write(os, r->records[tail % RING_SIZE]);
+            r->tail.store(tail, std::memory_order_release);
+            if(auto drops = r->drops.load(std::memory_order_relaxed); drops != r->reported) {
+                record rec{std::chrono::system_clock::now(), Level::WARNING, 0, {}};
+                const auto msg = std::to_string(drops - r->reported) + " log records dropped.";
+                rec.len = std::min(msg.size(), RECORD_SIZE);
+                std::memcpy(rec.message.data(), msg.data(), rec.len);
+                write(os, rec);
+                r->reported = drops;
+                wrote = true;
+            }
         }
+        return wrote;
+    }
+    void Logger::run() {
+        std::unique_lock<std::mutex> lk(log_mutex_);
+        while(!stop_) {
+            auto *os = s_output_stream_.load(std::memory_order_relaxed);
+            if(drain(*os))
+                os->flush();
+            cv_.wait_for(lk, WRITE_INTERVAL);
+        }
+        auto *os = s_output_stream_.load(std::memory_order_relaxed);
+        if(drain(*os))
+            os->flush();
     }
     void Logger::flush() {
         std::lock_guard<std::mutex> lk(log_mutex_);
-        s_output_stream_.load(std::memory_order_relaxed)->flush();
+        auto *os = s_output_stream_.load(std::memory_order_relaxed);
+        drain(*os);
+        os->flush();
+    }
+    std::size_t Logger::dropped() const {
+        std::size_t drops = 0;
+        for(auto *r = rings_.load(std::memory_order_acquire); r; r = r->next)
+            drops += r->drops.load(std::memory_order_relaxed);
+        return drops;
     }
     void Logger::emergency(const std::string_view& message){
         log(Level::EMERGENCY, message);
@@ -83,8 +296,7 @@ namespace cloudbus {
     void Logger::debug(const std::string_view& message){
         log(Level::DEBUG, message);
     }
-    std::string Logger::getCurrentTimestamp() {
-        const auto now = std::chrono::system_clock::now();
+    std::string Logger::getCurrentTimestamp(const std::chrono::system_clock::time_point& now) {
         const auto in_time_t = std::chrono::system_clock::to_time_t(now);
         std::stringstream ss;
         std::tm tm_buf{};
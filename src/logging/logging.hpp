@@ -13,11 +13,17 @@
 *   You should have received a copy of the GNU General Public License along with Cloudbus.
 *   If not, see <https://www.gnu.org/licenses/>.
 */
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <string_view>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #pragma once
 #ifndef CLOUDBUS_LOGGING
@@ -50,10 +56,77 @@ namespace cloudbus {
             return instance;
         }
 
+        /* Token buckets for one call site, one bucket per error *
+         * code. Declare one static thread_local per call site.   *
+         * The count of messages held back is logged with the     *
+         * next message let through, or by flush() once the       *
+         * bucket has refilled, so a storm that stops is still    *
+         * summarized.                                            */
+        class rate_limit {
+        public:
+            using clock_type = std::chrono::steady_clock;
+            using time_point = clock_type::time_point;
+            static constexpr std::size_t BURST = 10;
+            static constexpr std::chrono::seconds INTERVAL{1};
+            static constexpr std::size_t MAX_CODES = 16;
+
+            rate_limit();
+            ~rate_limit();
+
+            /* True if a message with code may be logged. suppressed is *
+             * set to the number of messages with code that were held   *
+             * back since the last one that was let through.            */
+            bool allow(int code, std::size_t& suppressed, const time_point& now = clock_type::now());
+            /* Logs a summary for every bucket of the calling thread's *
+             * call sites that has held messages back and refilled.    */
+            static void flush(const time_point& now = clock_type::now());
+            /* When flush() next has work, max() if it has none. */
+            static time_point flush_due();
+
+            rate_limit(const rate_limit& other) = delete;
+            rate_limit& operator=(const rate_limit& other) = delete;
+            rate_limit(rate_limit&& other) = delete;
+            rate_limit& operator=(rate_limit&& other) = delete;
+
+        private:
+            struct bucket {
+                int code;
+                std::size_t tokens, suppressed;
+                time_point refilled;
+                /* the last message let through, for the summary. */
+                Level level;
+                std::string message;
+            };
+            std::vector<bucket> _buckets;
+            bucket *_last;
+
+            void remember(Level level, const std::string& message);
+            static void summarize(bucket& b);
+            static std::vector<rate_limit*>& registry();
+            static time_point& due();
+            friend class Logger;
+        };
+
         void setLevel(Level level);
         Level getLevel() const;
         void log(Level level, const std::string_view& message);
+        /* Rate limited log, message() is only called to build *
+         * the messages that are let through.                   */
+        template<class Fn>
+        void log(Level level, rate_limit& limit, int code, Fn&& message) {
+            std::size_t suppressed = 0;
+            if(level > getLevel() || !limit.allow(code, suppressed))
+                return;
+            std::string msg(message());
+            limit.remember(level, msg);
+            if(suppressed)
+                msg += " (" + std::to_string(suppressed) + " similar messages suppressed)";
+            return log(level, msg);
+        }
+        /* Writes out every queued record and flushes the stream. */
         void flush();
+        /* Records dropped because a queue was full. */
+        std::size_t dropped() const;
 
         void emergency(const std::string_view& message);
         void alert(const std::string_view& message);
@@ -70,14 +143,47 @@ namespace cloudbus {
         Logger& operator=(Logger&& other) = delete;
 
     private:
-        Logger() : level_(Level::WARNING) {}
-        ~Logger() = default;
+        /* Each thread queues its records on its own single     *
+         * producer ring and a background thread formats and    *
+         * writes them, so logging never blocks the caller.     *
+         * Messages longer than a record are truncated. Rings   *
+         * are never freed, a thread that exits hands its ring  *
+         * to the next thread that logs.                        */
+        static constexpr std::size_t RECORD_SIZE = 512;
+        static constexpr std::size_t RING_SIZE = 256;
+        struct record {
+            std::chrono::system_clock::time_point time;
+            Level level;
+            std::uint32_t len;
+            std::array<char, RECORD_SIZE> message;
+        };
+        struct ring {
+            alignas(64) std::atomic<std::size_t> head{0};
+            alignas(64) std::atomic<std::size_t> tail{0};
+            std::atomic<std::size_t> drops{0};
+            std::size_t reported{0};
+            std::atomic<bool> claimed{true};
+            ring *next{nullptr};
+            std::array<record, RING_SIZE> records;
+        };
+        struct ring_holder;
+
+        Logger();
+        ~Logger();
 
-        std::string getCurrentTimestamp();
+        ring *local_ring();
+        bool drain(std::ostream& os);
+        void write(std::ostream& os, const record& rec);
+        void run();
+        std::string getCurrentTimestamp(const std::chrono::system_clock::time_point& now);
         std::string levelToString(Level level);
 
         std::mutex log_mutex_;
+        std::condition_variable cv_;
+        bool stop_;
         std::atomic<Level> level_;
+        std::atomic<ring*> rings_;
+        std::thread writer_;
         static std::atomic<std::ostream*> s_output_stream_;
     };
 }
@@ -15,9 +15,12 @@
 */
 #include "../logging.hpp"
 #include "../metrics.hpp"
+#include "../stats.hpp"
 #include "manager.hpp"
+#include <algorithm>
 #include <thread>
 #include <fcntl.h>
+#include <unistd.h>
 #include <ctime>
 namespace cloudbus {
     volatile std::sig_atomic_t manager_base::sigterm=0, manager_base::sighup=0, manager_base::sigint=0, manager_base::sigusr1=0;
@@ -65,6 +68,35 @@ namespace cloudbus {
     manager_base::manager_base(const config_type& config):
         _config{config}
     { unmask_handlers(); }
+    void manager_base::open_stats(const std::string& component) {
+        std::string path = stats::default_path(component, getpid());
+        for(const auto&[heading, section]: _config.sections()) {
+            std::string h = heading;
+            std::transform(h.begin(), h.end(), h.begin(), [](unsigned char c){ return std::tolower(c); });
+            if(h != "cloudbus")
+                continue;
+            for(const auto&[key, value]: section) {
+                std::string k = key, v = value;
+                std::transform(k.begin(), k.end(), k.begin(), [](unsigned char c){ return std::tolower(c); });
+                std::transform(v.begin(), v.end(), v.begin(), [](unsigned char c){ return std::tolower(c); });
+                if(k != "stats")
+                    continue;
+                if(v == "off")
+                    return;
+                if(value.empty())
+                    throw std::invalid_argument("Invalid stats: " + value);
+                path = value;
+            }
+        }
+        try {
+            stats::open(path, component);
+        } catch(const std::system_error& e) {
+            Logger::getInstance().warn(std::string(e.what()) + ". Statistics are disabled.");
+        }
+    }
+    manager_base::~manager_base() {
+        stats::close();
+    }
     void manager_base::start(const std::string& name, node_type& node) {
         pipe_type p{};
         if(pipe(p.data()))
@@ -72,12 +104,14 @@ namespace cloudbus {
         for(const auto& hnd: p)
             set_flags(hnd);
         mask_handlers();
-        _threads.try_emplace(name, p, std::thread([](node_type& n, int noticefd){
+        _threads.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple(p, std::thread([](node_type& n, int noticefd, const std::string& service){
             metrics::get().make_node();
+            stats::attach(service);
             int rc = n.run(noticefd);
+            stats::detach();
             metrics::get().erase_node();
             return rc;
-        }, std::ref(node), p[0]));
+        }, std::ref(node), p[0], name)));
         unmask_handlers();
     }
     void manager_base::join(threads_type::iterator it) {
@@ -116,13 +150,26 @@ namespace cloudbus {
         join(it);
         return _threads.erase(it);
     }
+    void manager_base::stop(const std::string& name) {
+        /* workers drain concurrently, so notify all of them before joining. */
+        auto[begin, end] = _threads.equal_range(name);
+        for(auto it = begin; it != end; ++it) {
+            auto&[p, t] = it->second;
+            if(notify_thread(p[1], SIGTERM))
+                throw_system_error("Unable to terminate thread.");
+        }
+        while(begin != end) {
+            join(begin);
+            begin = _threads.erase(begin);
+        }
+    }
     int manager_base::handle_signal(int sig) {
         return _handle_signal(sig);
     }
     int manager_base::_handle_signal(int sig) {
         if(sig == SIGTERM || sig == SIGINT || sig == SIGHUP) {
-            auto it = _threads.begin();
-            while( (it = stop(it)) != _threads.end() );
+            while(!_threads.empty())
+                stop(std::string(_threads.begin()->first));
             return 0;
         }
         return sig;
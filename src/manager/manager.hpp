@@ -30,7 +30,7 @@ namespace cloudbus {
             using node_type = node_base;
             using pipe_type = std::array<int, 2>;
             using thread_type = std::tuple<pipe_type, std::thread>;
-            using threads_type = std::map<std::string, thread_type>;
+            using threads_type = std::multimap<std::string, thread_type>;
             static volatile std::sig_atomic_t sigterm, sighup, sigint, sigusr1;
 
             explicit manager_base(const config::configuration& config);
@@ -42,8 +42,12 @@ namespace cloudbus {
             int handle_signal(int sig);
             void join(threads_type::iterator it);
             threads_type::iterator stop(threads_type::iterator it);
+            void stop(const std::string& name);
+            /* Opens the statistics file set by stats= in the *
+             * [Cloudbus] section, stats=off disables it.      */
+            void open_stats(const std::string& component);
 
-            virtual ~manager_base() = default;
+            virtual ~manager_base();
 
             manager_base() = delete;
             manager_base(const manager_base& other) = delete;
@@ -66,11 +70,17 @@ namespace cloudbus {
         public:
             using Base = manager_base;
             using node_type = NodeT;
-            using services_type = std::map<std::string, node_type>;
+            using workers_type = std::list<node_type>;
+            using services_type = std::map<std::string, workers_type>;
 
             explicit basic_manager(const config_type& config):
                 Base(config), _services{}, mtime{}
             {
+                #ifdef COMPILE_CONTROLLER
+                    open_stats("controller");
+                #elif defined(COMPILE_SEGMENT)
+                    open_stats("segment");
+                #endif
                 merge(config);
                 if( const auto *path = std::getenv("CONFIG_PATH") ) {
                     mtime = std::filesystem::last_write_time(path);
@@ -92,10 +102,10 @@ namespace cloudbus {
             void merge(const config_type& config) {
                 auto ity = services().begin();
                 while(ity != services().end()) {
-                    const auto&[heading, node] = *ity++;
+                    const auto&[heading, workers] = *ity++;
                     auto itx = config.sections().find(heading);
                     if(itx == config.sections().end()) {
-                        stop(threads().find(heading));
+                        stop(heading);
                         ity = services().erase(--ity);
                     }
                 }
@@ -103,20 +113,16 @@ namespace cloudbus {
                     std::string h = heading;
                     std::transform(h.begin(), h.end(), h.begin(), [](unsigned char c){ return std::tolower(c); });
                     if(h != "cloudbus") {
-                        auto[ity, emplaced] = services().try_emplace(heading, section);
-                        while(!emplaced) {
-                            auto&[head, node] = *ity;
-                            if(node.conf() == section)
-                                break;
-                            stop(threads().find(heading));
-                            services().erase(ity);
-                            auto[itv, empl] = services().try_emplace(heading, section);
-                            ity = itv; emplaced = empl;
-                        }
-                        if(emplaced) {
-                            auto&[head, node] = *ity;
-                            start(heading, node);
+                        auto&[head, workers] = *services().try_emplace(heading).first;
+                        if(!workers.empty()) {
+                            if(workers.front().conf() == section)
+                                continue;
+                            stop(heading);
+                            workers.clear();
                         }
+                        /* each worker owns its own node, triggers and listener. */
+                        for(int i = node_type::connector_type::workers(section); i > 0; --i)
+                            start(heading, workers.emplace_back(section));
                     }
                 }
             }
@@ -13,7 +13,10 @@
 *   You should have received a copy of the GNU General Public License along with Cloudbus.
 *   If not, see <https://www.gnu.org/licenses/>.
 */
+#include "../formats.hpp"
+#include <algorithm>
 #include <memory>
+#include <sstream>
 #include <tuple>
 #include <vector>
 
@@ -60,6 +63,9 @@ namespace cloudbus {
             typename south_buffers::iterator marshal(const typename south_type::handle_type& s){ return _marshal(s); }
             north_buffers& north() { return _north; }
             south_buffers& south() { return _south; }
+            /* Drops the buffers that hold no partial message, *
+             * the next read on their stream recreates them.   */
+            std::size_t release() { return _release(_north) + _release(_south); }
 
             virtual ~basic_marshaller() = default;
 
@@ -73,6 +79,22 @@ namespace cloudbus {
             virtual typename south_buffers::iterator _marshal(const typename south_type::handle_type& s) { return _south.end(); }
 
         private:
+            static bool at_rest(std::stringstream& buf) { return buf.tellg() == buf.tellp(); }
+            static bool at_rest(messages::xmsgstream& buf) { return buf.eof() || buf.tellp() == 0; }
+            template<class Buffers>
+            static std::size_t _release(Buffers& buffers) {
+                auto end = std::remove_if(
+                        buffers.begin(),
+                        buffers.end(),
+                    [](auto& buffer) {
+                        return buffer.ptr.expired() || at_rest(*buffer.pbuf);
+                    }
+                );
+                const std::size_t n = buffers.end() - end;
+                buffers.erase(end, buffers.end());
+                return n;
+            }
+
             north_buffers _north;
             south_buffers _south;
     };
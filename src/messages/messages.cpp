@@ -16,19 +16,57 @@
 #include "messages.hpp"
 #include <array>
 #include <charconv>
-#include <fstream>
 #include <chrono>
+#include <cerrno>
 #include <cstring>
+#include <sys/random.h>
 namespace cloudbus{
     namespace messages {
         static constexpr std::uint16_t VARIANT = 0x80;
+        namespace {
+            /* Random bytes are drawn from getrandom() a page at a time *
+             * into a per-thread pool, so a new session costs a copy    *
+             * rather than an open(), read() and close() of urandom.    */
+            struct generator {
+                static constexpr std::size_t POOLSIZE = 4096;
+                std::array<char, POOLSIZE> pool;
+                std::size_t pos = POOLSIZE;
+                /* last v7 timestamp and the counter within it. */
+                std::uint64_t ms = 0;
+                std::uint16_t seq = 0;
+
+                bool read(char *buf, std::size_t len){
+                    if(POOLSIZE-pos < len && !refill())
+                        return false;
+                    std::memcpy(buf, pool.data()+pos, len);
+                    std::memset(pool.data()+pos, 0, len);
+                    pos += len;
+                    return true;
+                }
+                bool refill(){
+                    std::size_t filled = 0;
+                    while(filled < POOLSIZE){
+                        auto n = getrandom(pool.data()+filled, POOLSIZE-filled, 0);
+                        if(n < 0){
+                            if(errno == EINTR)
+                                continue;
+                            return false;
+                        }
+                        filled += n;
+                    }
+                    pos = 0;
+                    return true;
+                }
+            };
+            static generator& local_generator(){
+                static thread_local generator gen;
+                return gen;
+            }
+        }
         uuid make_uuid_v4(){
             constexpr std::uint16_t UUID_VERSION = 0x4000;
             uuid tmp{};
-            if(std::ifstream urnd("/dev/urandom", urnd.in | urnd.binary);
-                urnd.good()
-            ){
-                urnd.read(reinterpret_cast<char*>(&tmp), sizeof(uuid));
+            if(local_generator().read(reinterpret_cast<char*>(&tmp), sizeof(uuid))){
                 tmp.time_high_version &= TIME_HIGH_MAX;
                 tmp.time_high_version |= UUID_VERSION;
                 tmp.clock_seq_reserved &= CLOCK_SEQ_MAX;
@@ -40,19 +78,27 @@ namespace cloudbus{
         uuid make_uuid_v7(){
             constexpr std::uint16_t UUID_VERSION = 0x7000;
             constexpr std::uint64_t TIME_LOW_MASK = UINT32_MAX, TIME_MID_MASK = UINT16_MAX;
+            /* a new millisecond starts the counter in its lower half. */
+            constexpr std::uint16_t SEQ_SEED_MASK = TIME_HIGH_MAX >> 1;
+            auto& gen = local_generator();
             uuid tmp{};
-            if(std::ifstream urnd("/dev/urandom", urnd.in | urnd.binary);
-                urnd.good()
-            ){
+            char *start = reinterpret_cast<char*>(&tmp)+offsetof(uuid, time_high_version);
+            if(gen.read(start, sizeof(uuid)-offsetof(uuid, time_high_version))){
                 auto timepoint = std::chrono::system_clock::now().time_since_epoch();
                 std::uint64_t ms_count = std::chrono::duration_cast<std::chrono::milliseconds>(
                                             timepoint).count();
-                tmp.time_low = (ms_count & TIME_LOW_MASK);
-                tmp.time_mid = ((ms_count>>32) & TIME_MID_MASK);
-                char *start = reinterpret_cast<char*>(&tmp)+offsetof(uuid, time_high_version);
-                urnd.read(start, sizeof(uuid)-offsetof(uuid, time_high_version));
-                tmp.time_high_version &= TIME_HIGH_MAX;
-                tmp.time_high_version |= UUID_VERSION;
+                /* the counter keeps the ids of a thread monotonic within *
+                 * a millisecond, and across a clock that steps backwards. */
+                if(ms_count > gen.ms) {
+                    gen.ms = ms_count;
+                    gen.seq = tmp.time_high_version & SEQ_SEED_MASK;
+                } else if(++gen.seq > TIME_HIGH_MAX) {
+                    ++gen.ms;
+                    gen.seq = tmp.time_high_version & SEQ_SEED_MASK;
+                }
+                tmp.time_low = (gen.ms & TIME_LOW_MASK);
+                tmp.time_mid = ((gen.ms>>32) & TIME_MID_MASK);
+                tmp.time_high_version = gen.seq | UUID_VERSION;
                 tmp.clock_seq_reserved &= CLOCK_SEQ_MAX;
                 tmp.clock_seq_reserved |= VARIANT;
             }
@@ -15,210 +15,85 @@
 */
 #include "metrics.hpp"
 namespace cloudbus {
-    static constexpr std::size_t span = 3;
-    static constexpr stream_metrics::duration_type init_intercompletion{0}, init_interarrival{0};
-    namespace {
-        template<class T>
-        static bool owner_equal(const std::weak_ptr<T>& p1, const std::weak_ptr<T>& p2) {
-            return !p1.owner_before(p2) && !p2.owner_before(p1);
-        }
-        static auto update_ewma(const stream_metrics::duration_type& delta) {
-            using duration_type = stream_metrics::duration_type;
-            auto denom = duration_type(span+1);
-            if(delta > duration_type::max()/2)
-            {
-                auto overflow = delta - duration_type::max() % delta;
-                auto rem1 = duration_type::max() % denom, rem2 = overflow % denom;
-                return duration_type(duration_type::max()/denom +
-                    overflow/denom +
-                    (rem1+rem2)/denom);
-            }
-            else if (delta < duration_type::min()/2)
-            {
-                auto underflow = delta - duration_type::min() % delta;
-                auto rem1 = duration_type::min() % denom, rem2 = underflow % denom;
-                return duration_type(duration_type::min()/denom +
-                    underflow/denom +
-                    (rem1+rem2)/denom);
-            } else return duration_type(2*delta/denom);
-        }
-        static stream_metrics::metrics_vec::iterator find_metric(
-            stream_metrics::metrics_vec& measurements,
-            const stream_metrics::weak_ptr& ptr
-        ){
-            using metric_type = stream_metrics::metric_type;
-            using weak_ptr = stream_metrics::weak_ptr;
-            auto begin = measurements.begin(), end = measurements.end();
-            if(ptr.expired())
-                return end;
-            struct {
-                bool operator()(const metric_type& lhs, const weak_ptr& rhs) {
-                    return lhs.wp.owner_before(rhs);
-                }
-            } comp{};
-            auto lb = std::lower_bound(begin, end, ptr, comp);
-            if(lb == end || owner_equal(lb->wp, ptr))
-                return lb;
-            return end;
-        }
-        static auto remove_and_find_insertion_point(
-            const stream_metrics::metrics_vec::iterator& begin,
-            const stream_metrics::metrics_vec::iterator& end,
-            const stream_metrics::weak_ptr& ptr
-        ){
-            auto put = begin, get = put;
-            while(get != end) {
-                auto& wp = get->wp;
-                if(wp.expired()) {
-                    ++get;
-                } else if (ptr.owner_before(wp)) {
-                    break;
-                } else {
-                    *put++ = std::move(*get++);
-                }
-            }
-            return std::make_tuple(put, get);
-        }
-        static auto insert_at_pos(
-            stream_metrics::metrics_vec& measurements,
-            const stream_metrics::metrics_vec::iterator& put,
-            const stream_metrics::metrics_vec::iterator& get,
-            stream_metrics::weak_ptr&& ptr,
-            const stream_metrics::time_point& t
-        ){
-            if(put != get) {
-                *put = {
-                    std::move(ptr),
-                    init_interarrival,
-                    init_intercompletion,
-                    t,
-                    t
-                };
-                return --measurements.erase(put+1, get);
-            } else {
-                return measurements.insert(
-                    put,
-                    {
-                        std::move(ptr),
-                        init_interarrival,
-                        init_intercompletion,
-                        t,
-                        t
-                    }
-                );
-            }
-        }
-        template<class T>
-        static bool shrink_to_fit(std::vector<T>& vec){
-            static constexpr std::size_t THRESH = 256;
-            bool resized = false;
-            const std::size_t capacity = vec.capacity();
-            if( capacity > THRESH &&
-                vec.size() < capacity/8
-            ){
-                vec  = std::vector<T>(
-                    std::make_move_iterator(vec.begin()),
-                    std::make_move_iterator(vec.end())
-                );
-                resized = true;
-            }
-            return resized;
-        }
-        static stream_metrics::metrics_vec::iterator insert_metric(
-            stream_metrics::metrics_vec& measurements,
-            stream_metrics::weak_ptr&& ptr,
-            const stream_metrics::time_point& t
-        ){
-            /* Find the insert position, marking expired elements for deletion as we go. */
-            auto begin = measurements.begin(), end = measurements.end();
-            auto[put, get] = remove_and_find_insertion_point(begin, end, ptr);
-            /* Insert the new element at put position. */
-            get = insert_at_pos(measurements, put, get, std::move(ptr), t);
-            /* Conditionally realloc measurements down to size. */
-            const auto index = std::distance(begin=measurements.begin(), get);
-            if(shrink_to_fit(measurements))
-                begin = measurements.begin();
-            return begin + index;
-        }
+    thread_local metrics::entry *metrics::local = nullptr;
+    metrics::entry *metrics::find(const std::thread::id& tid) {
+        for(auto *e = head.load(std::memory_order_acquire); e; e = e->next)
+            if(e->tid.load(std::memory_order_acquire) == tid)
+                return e;
+        return nullptr;
     }
-    stream_metrics::duration_type stream_metrics::add_completion(
-        weak_ptr ptr,
-        const time_point& t
-    ){
-        if(ptr.expired())
-            return duration_type(-1);
-        std::lock_guard<std::mutex> lk(mtx);
-        auto metric_it = find_metric(measurements, ptr);
-        if(metric_it == measurements.end()) {
-            insert_metric(
-                measurements,
-                std::move(ptr),
-                t
-            );
-            return init_intercompletion;
-        }
-        auto intercompletion = std::chrono::duration_cast<duration_type>(
-            t - metric_it->last_completion
-        );
-        metric_it->last_completion = t;
-        auto delta = intercompletion - metric_it->intercompletion;
-        return metric_it->intercompletion += update_ewma(delta);
-    }
-    stream_metrics::duration_type stream_metrics::add_arrival(
-        weak_ptr ptr,
-        const time_point& t
-    ){
-        if(ptr.expired())
-            return duration_type(-1);
-        std::lock_guard<std::mutex> lk(mtx);
-        auto metric_it = find_metric(measurements, ptr);
-        if(metric_it == measurements.end()) {
-            insert_metric(
-                measurements,
-                std::move(ptr),
-                t
-            );
-            return init_interarrival;
-        }
-        auto interarrival = std::chrono::duration_cast<duration_type>(
-            t - metric_it->last_arrival
-        );
-        metric_it->last_arrival = t;
-        auto delta = interarrival - metric_it->interarrival;
-        return metric_it->interarrival += update_ewma(delta);
-    }
-    stream_metrics::metrics_vec stream_metrics::get_all_measurements() {
-        std::lock_guard<std::mutex> lk(mtx);
-        return measurements;
+    node_metrics& metrics::node(const std::thread::id& tid) {
+        if(local && tid == std::this_thread::get_id())
+            return local->node;
+        return make_node(tid);
     }
     node_metrics& metrics::make_node(const std::thread::id& tid) {
-        std::lock_guard<std::mutex> lk(mtx);
-        auto[it, emplaced] = nodes.try_emplace(tid);
-        return it->second;
+        const bool self = (tid == std::this_thread::get_id());
+        auto *e = find(tid);
+        for(auto *it = head.load(std::memory_order_acquire); !e && it; it = it->next) {
+            std::thread::id none{};
+            if(it->tid.compare_exchange_strong(none, tid, std::memory_order_acq_rel))
+                e = it;
+        }
+        if(!e) {
+            e = new entry{};
+            e->tid.store(tid, std::memory_order_relaxed);
+            e->next = head.load(std::memory_order_relaxed);
+            while(!head.compare_exchange_weak(
+                e->next, e,
+                std::memory_order_release,
+                std::memory_order_relaxed
+            ));
+        }
+        if(self) {
+            e->node.buffers.store(&::io::buffers::pool::stats());
+            local = e;
+        }
+        return e->node;
     }
     std::atomic<std::size_t>& metrics::arrivals(const std::thread::id& tid) {
-        std::lock_guard<std::mutex> lk(mtx);
-        return nodes[tid].arrivals;
-    }
-    stream_metrics& metrics::streams(const std::thread::id& tid) {
-        std::lock_guard<std::mutex> lk(mtx);
-        return nodes[tid].streams;
+        return node(tid).arrivals;
     }
     metrics::metrics_vec metrics::get_all_measurements() {
         metrics_vec m;
-        std::lock_guard<std::mutex> lk(mtx);
-        m.reserve(nodes.size());
-        for(auto&[tid, nm]: nodes) {
-            m.push_back({
-                tid,
-                nm.arrivals.load(std::memory_order_relaxed),
-                nm.streams.get_all_measurements()
-            });
+        for(auto *e = head.load(std::memory_order_acquire); e; e = e->next) {
+            e->readers.fetch_add(1);
+            const auto tid = e->tid.load(std::memory_order_acquire);
+            if(tid != std::thread::id()) {
+                const auto *buffers = e->node.buffers.load();
+                m.push_back({
+                    tid,
+                    e->node.arrivals.load(std::memory_order_relaxed),
+                    buffers ? buffers->hits.load(std::memory_order_relaxed) : 0,
+                    buffers ? buffers->misses.load(std::memory_order_relaxed) : 0
+                });
+            }
+            e->readers.fetch_sub(1, std::memory_order_release);
         }
         return m;
     }
     void metrics::erase_node(const std::thread::id& tid) {
-        std::lock_guard<std::mutex> lk(mtx);
-        nodes.erase(tid);
+        auto *e = find(tid);
+        if(!e)
+            return;
+        /* the pool counters die with the thread, so wait out  *
+         * any reader that loaded them before they were reset.  *
+         * Both sides store then load, so both must be seq_cst  *
+         * for one of them to see the other's store.            */
+        e->node.buffers.store(nullptr, std::memory_order_seq_cst);
+        while(e->readers.load(std::memory_order_seq_cst))
+            std::this_thread::yield();
+        e->node.arrivals.store(0, std::memory_order_relaxed);
+        if(local == e)
+            local = nullptr;
+        e->tid.store(std::thread::id(), std::memory_order_release);
+    }
+    metrics::~metrics() {
+        auto *e = head.load(std::memory_order_acquire);
+        while(e) {
+            auto *next = e->next;
+            delete e;
+            e = next;
+        }
     }
 }
@@ -14,52 +14,33 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "../interfaces.hpp"
+#include "../io/pool.hpp"
 #include <atomic>
 #include <thread>
-#include <map>
-#include <mutex>
 #pragma once
 #ifndef CLOUDBUS_METRICS
 #define CLOUDBUS_METRICS
 namespace cloudbus {
-    class stream_metrics {
-        public:
-            using stream_type = interface_base::stream_type;
-            using clock_type = std::chrono::steady_clock;
-            using duration_type = std::chrono::milliseconds;
-            using weak_ptr = std::weak_ptr<stream_type>;
-            using shared_ptr = std::shared_ptr<stream_type>;
-            using time_point = clock_type::time_point;
-
-            struct metric_type {
-                weak_ptr wp;
-                duration_type interarrival, intercompletion;
-                time_point last_arrival, last_completion;
-            };
-            using metrics_vec = std::vector<metric_type>;
-
-            duration_type add_completion(weak_ptr ptr, const time_point& t=clock_type::now());
-            duration_type add_arrival(weak_ptr ptr, const time_point& t=clock_type::now());
-            metrics_vec get_all_measurements();
-        private:
-            std::mutex mtx;
-            metrics_vec measurements;
-    };
     struct node_metrics {
             /* carried traffic = offered traffic unless offered traffic *
              * exceeds capacity. I only need to count arrivals if I am  *
              * interested in throughput. I will need to compute capacity*
              * using a different method.                                */
             std::atomic<std::size_t> arrivals;
-            stream_metrics streams;
+            /* buffer pool counters of the node's thread. */
+            std::atomic<const ::io::buffers::pool::stats_type*> buffers;
     };
+    /* Nodes are registered on a lock-free list that only grows. *
+     * Erased nodes are recycled by the next thread to register, *
+     * so the list is never longer than the most threads alive   *
+     * at once. The owning thread finds its node through a       *
+     * thread_local, so counting an arrival takes no lock.       */
     class metrics {
         public:
-            using node_registry = std::map<std::thread::id, node_metrics>;
             struct metric {
                 std::thread::id tid;
                 std::size_t arrivals;
-                stream_metrics::metrics_vec measurements;
+                std::size_t pool_hits, pool_misses;
             };
             using metrics_vec = std::vector<metric>;
             static inline metrics& get() {
@@ -69,7 +50,7 @@ namespace cloudbus {
 
             node_metrics& make_node(const std::thread::id& tid = std::this_thread::get_id());
             std::atomic<std::size_t>& arrivals(const std::thread::id& tid = std::this_thread::get_id());
-            stream_metrics& streams(const std::thread::id& tid = std::this_thread::get_id());
+            /* safe to call from any thread. */
             metrics_vec get_all_measurements();
             void erase_node(const std::thread::id& tid = std::this_thread::get_id());
 
@@ -78,10 +59,19 @@ namespace cloudbus {
             metrics(metrics&& other) = delete;
             metrics& operator=(metrics&& other) = delete;
         private:
-            std::mutex mtx;
-            node_registry nodes;
-            metrics() = default;
-            ~metrics() = default;
+            struct entry {
+                std::atomic<std::thread::id> tid;
+                /* readers of the buffer counters, see erase_node(). */
+                std::atomic<std::size_t> readers;
+                node_metrics node;
+                entry *next;
+            };
+            std::atomic<entry*> head;
+            static thread_local entry *local;
+            entry *find(const std::thread::id& tid);
+            node_metrics& node(const std::thread::id& tid);
+            metrics(): head{nullptr} {}
+            ~metrics();
     };
 }
 #endif
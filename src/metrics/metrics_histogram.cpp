@@ -0,0 +1,55 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "metrics_histogram.hpp"
+#include <algorithm>
+#include <cmath>
+namespace cloudbus {
+    std::size_t histogram::index(value_type value) {
+        constexpr value_type HALF = SUB_BUCKETS/2;
+        if(value < SUB_BUCKETS)
+            return value;
+        if(value >> MAX_BITS)
+            return NBUCKETS-1;
+        /* value >> shift lies in [HALF, SUB_BUCKETS). */
+        const unsigned shift = (63 - __builtin_clzll(value)) - (SUB_BITS-1);
+        return shift*HALF + (value >> shift);
+    }
+    histogram::value_type histogram::highest(std::size_t idx) {
+        constexpr value_type HALF = SUB_BUCKETS/2;
+        if(idx < SUB_BUCKETS)
+            return idx;
+        const unsigned shift = idx/HALF - 1;
+        const value_type sub = idx%HALF + HALF;
+        return ((sub+1) << shift) - 1;
+    }
+    histogram::value_type histogram::percentile(double p) const {
+        if(!_total)
+            return 0;
+        p = std::min(std::max(p, 0.0), 100.0);
+        const value_type rank = std::max<value_type>(1, std::ceil(p/100.0*_total));
+        value_type seen = 0;
+        for(std::size_t i=0; i < NBUCKETS; ++i)
+            if((seen += _counts[i]) >= rank)
+                return highest(i);
+        return highest(NBUCKETS-1);
+    }
+    histogram& histogram::operator+=(const histogram& other) {
+        for(std::size_t i=0; i < NBUCKETS; ++i)
+            _counts[i] += other._counts[i];
+        _total += other._total;
+        return *this;
+    }
+}
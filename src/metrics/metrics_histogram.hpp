@@ -0,0 +1,67 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include <array>
+#include <chrono>
+#include <cstdint>
+#pragma once
+#ifndef CLOUDBUS_METRICS_HISTOGRAM
+#define CLOUDBUS_METRICS_HISTOGRAM
+namespace cloudbus {
+    /* Log-linear histogram of microseconds in the style of   *
+     * HdrHistogram. Values below SUB_BUCKETS are counted     *
+     * exactly, and each power of two above that is split     *
+     * into SUB_BUCKETS/2 linear buckets, so every value is   *
+     * kept to within 2/SUB_BUCKETS (about 6%) of itself.     *
+     * Values past 2^MAX_BITS us (about 71 minutes) go to the *
+     * last bucket. Histograms are plain arrays of counters,  *
+     * so they can be copied into shared memory and merged    *
+     * with +=.                                               */
+    class histogram {
+        public:
+            using value_type = std::uint64_t;
+            static constexpr unsigned SUB_BITS = 5;
+            static constexpr value_type SUB_BUCKETS = value_type(1) << SUB_BITS;
+            static constexpr unsigned MAX_BITS = 32;
+            static constexpr std::size_t NBUCKETS = (MAX_BITS-SUB_BITS+2)*(SUB_BUCKETS/2);
+            using counts_type = std::array<value_type, NBUCKETS>;
+
+            static std::size_t index(value_type value);
+            /* the largest value counted in bucket idx. */
+            static value_type highest(std::size_t idx);
+
+            void record(value_type usec, value_type n=1) {
+                _counts[index(usec)] += n;
+                _total += n;
+            }
+            template<class Rep, class Period>
+            void record(const std::chrono::duration<Rep, Period>& d) {
+                const auto usec = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+                record(usec < 0 ? 0 : usec);
+            }
+            value_type count() const { return _total; }
+            const counts_type& counts() const { return _counts; }
+            /* the value that p percent of the values are at or below, *
+             * rounded up to the top of its bucket, 0 if empty.        */
+            value_type percentile(double p) const;
+            void reset() { *this = histogram{}; }
+            histogram& operator+=(const histogram& other);
+
+        private:
+            counts_type _counts{};
+            value_type _total{0};
+    };
+}
+#endif
@@ -0,0 +1,29 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "metrics_loop.hpp"
+namespace cloudbus {
+    loop_metrics& loop_metrics::local() {
+        static thread_local loop_metrics metrics{};
+        return metrics;
+    }
+    loop_metrics::timer::~timer() {
+        if(_start == clock_type::time_point())
+            return;
+        auto& metrics = local();
+        metrics.handler_ns[_which] += std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - _start).count();
+        ++metrics.handler_calls[_which];
+    }
+}
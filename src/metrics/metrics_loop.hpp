@@ -0,0 +1,74 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "metrics_histogram.hpp"
+#include <chrono>
+#include <cstdint>
+#pragma once
+#ifndef CLOUDBUS_METRICS_LOOP
+#define CLOUDBUS_METRICS_LOOP
+namespace cloudbus {
+    /* Event loop health of one node thread. The node's loop and   *
+     * its connector's handlers run on the same thread, so both    *
+     * record into a thread_local without being wired together,    *
+     * and the connector copies it into the statistics file. Like  *
+     * histogram it is plain counters that can be copied as is.    */
+    struct loop_metrics {
+        using clock_type = std::chrono::steady_clock;
+        enum handlers {
+            NORTH_ACCEPT, NORTH_POLLIN, NORTH_POLLOUT,
+            SOUTH_POLLIN, SOUTH_POLLOUT,
+            RESOLVER, TIMERS, NHANDLERS
+        };
+        /* Charges the time until it goes out of scope to a handler. */
+        class timer {
+            public:
+                explicit timer(handlers which):
+                    _which{which},
+                    _start{timing() ? clock_type::now() : clock_type::time_point()}
+                {}
+                ~timer();
+
+                timer(const timer& other) = delete;
+                timer& operator=(const timer& other) = delete;
+
+            private:
+                handlers _which;
+                clock_type::time_point _start;
+        };
+
+        /* time from each wakeup to the next wait. */
+        histogram busy;
+        /* ready events per wakeup, a count rather than microseconds. */
+        histogram events;
+        /* how much later than asked the waits that timed out returned. */
+        histogram late;
+        std::uint64_t wakeups, timeouts;
+        /* times the loop polled again after FAIRNESS rounds of handlers. */
+        std::uint64_t repolls;
+        std::uint64_t busy_ns;
+        std::uint64_t handler_ns[NHANDLERS], handler_calls[NHANDLERS];
+
+        /* The calling thread's metrics. */
+        static loop_metrics& local();
+        /* Handlers cost two clock reads per call to time, so only *
+         * the threads that publish statistics switch it on.       */
+        static bool& timing() {
+            static thread_local bool on = false;
+            return on;
+        }
+    };
+}
+#endif
@@ -14,15 +14,37 @@
 *   If not, see <https://www.gnu.org/licenses/>.
 */
 #include "node.hpp"
+#include "../metrics/metrics_loop.hpp"
 #include <algorithm>
+#include <iterator>
+#include <stdexcept>
 #include <unistd.h>
 namespace cloudbus{
+    static int poll_backend(const config::section& section){
+        int backend = node_base::trigger_type::POLL;
+        for(const auto&[key, value]: section) {
+            std::string k = key;
+            std::transform(k.begin(), k.end(), k.begin(), [](const unsigned char c){ return std::toupper(c); });
+            if(k == "POLLER") {
+                std::string v = value;
+                std::transform(v.begin(), v.end(), v.begin(), [](const unsigned char c){ return std::toupper(c); });
+                if(v == "EPOLL")
+                    backend = node_base::trigger_type::EPOLL;
+                else if(v == "IO_URING")
+                    backend = node_base::trigger_type::URING;
+                else if(v == "POLL")
+                    backend = node_base::trigger_type::POLL;
+                else throw std::invalid_argument("Invalid poller: " + value);
+            }
+        }
+        return backend;
+    }
     node_base::node_base():
         Base(_triggers), _triggers{},
         _timeout{default_timeout}, _conf{}
     {}
     node_base::node_base(const config::section& section) :
-        Base(_triggers), _triggers{},
+        Base(_triggers), _triggers{poll_backend(section)},
         _timeout{default_timeout}, _conf{section}
     {}
 
@@ -91,7 +113,9 @@ namespace cloudbus{
         return 0;
     }
     int node_base::_run(int notify_pipe) {
+        using clock_type = loop_metrics::clock_type;
         constexpr size_type FAIRNESS = 16;
+        auto& loop = loop_metrics::local();
         size_type n = 0;
         int notice = 0;
         if(!notify_pipe){
@@ -99,14 +123,35 @@ namespace cloudbus{
             std::signal(SIGINT, sighandler);
             std::signal(SIGHUP, sighandler);
         } else triggers().set(notify_pipe, POLLIN);
-        while( (n = triggers().wait(_timeout)) != trigger_type::npos ){
-            auto events = n ? triggers().events() : events_type();
+        /* the handlers move _timeout, so keep the one that was waited on. */
+        auto timeout = _timeout;
+        auto waited = clock_type::now();
+        while( (n = triggers().wait(timeout)) != trigger_type::npos ){
+            const auto woke = clock_type::now();
+            ++loop.wakeups;
+            if(!n && ++loop.timeouts && timeout.count() > -1)
+                loop.late.record(woke - waited - timeout);
+            /* handlers only ever see the events that are ready. */
+            events_type events;
+            if(n) {
+                events.reserve(n);
+                std::copy_if(
+                        triggers().events().cbegin(),
+                        triggers().events().cend(),
+                        std::back_inserter(events),
+                    [](const auto& event){
+                        return event.revents;
+                    }
+                );
+            }
+            loop.events.record(events.size());
             if(check_for_signal(events, notify_pipe, notice))
                 return notice;
             for(size_type i=0, handled=handle(events); handled; handled=handle(events)) {
                 if(handled == trigger_type::npos)
                     return notice;
                 if(++i == FAIRNESS) {
+                    ++loop.repolls;
                     if( (i = triggers().wait()) != trigger_type::npos ){
                         for(const auto& e: triggers().events()) {
                             if(e.revents && i--) {
@@ -140,6 +185,10 @@ namespace cloudbus{
                 if(check_for_signal(events, notify_pipe, notice))
                     return notice;
             }
+            waited = clock_type::now();
+            loop.busy.record(waited - woke);
+            loop.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(waited - woke).count();
+            timeout = _timeout;
         }
         return notice;
     }
@@ -15,6 +15,7 @@
 */
 #include "../io.hpp"
 #include "../config.hpp"
+#include "../logging.hpp"
 #include <csignal>
 #pragma once
 #ifndef CLOUDBUS_NODE
@@ -81,6 +82,25 @@ namespace cloudbus{
                     auto waitms = std::chrono::duration_cast<duration_type>(wait);
                     timeout() = (waitms.count() < 0) ? duration_type(0) : waitms;
                 }
+                /* wake up in time to release idle buffers. */
+                if(auto idle = _connector.idle(); idle.count() > 0 && idle < timeout())
+                    timeout() = idle;
+                /* and in time for the next connector timer, to   *
+                 * publish the last of the statistics, or to log  *
+                 * how many messages were suppressed.             */
+                for(auto next: {
+                    _connector.timeouts().next(),
+                    _connector.publish_due(),
+                    Logger::rate_limit::flush_due()
+                }) {
+                    if(next == decltype(next)::max())
+                        continue;
+                    auto wait = std::chrono::ceil<duration_type>(next - decltype(next)::clock::now());
+                    if(wait.count() < 0)
+                        wait = duration_type(0);
+                    if(timeout().count() < 0 || wait < timeout())
+                        timeout() = wait;
+                }
                 return handled;
             }
             virtual int _signal_handler(int sig) override {
@@ -0,0 +1,188 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "stats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+namespace cloudbus {
+    namespace stats {
+        namespace {
+            static void throw_system_error(const std::string& what) {
+                throw std::system_error(
+                    std::error_code(errno, std::system_category()),
+                    what
+                );
+            }
+            static std::uint64_t now_ms() {
+                using namespace std::chrono;
+                return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+            }
+            static void copy_name(char *dst, std::size_t len, const std::string& src) {
+                const auto n = std::min(len-1, src.size());
+                std::memcpy(dst, src.data(), n);
+                std::memset(dst+n, 0, len-n);
+            }
+            static region *shared = nullptr;
+            static std::string shared_path;
+            static thread_local slot *local_slot = nullptr;
+        }
+        std::string default_path(const std::string& component, pid_t pid) {
+            return "/dev/shm/cloudbus-" + component + "." + std::to_string(pid);
+        }
+        void open(const std::string& path, const std::string& component) {
+            close();
+            int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if(fd < 0)
+                throw_system_error("Unable to open statistics file: " + path);
+            if(ftruncate(fd, sizeof(region))) {
+                ::close(fd);
+                throw_system_error("Unable to size statistics file: " + path);
+            }
+            void *addr = mmap(nullptr, sizeof(region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if(addr == MAP_FAILED)
+                throw_system_error("Unable to map statistics file: " + path);
+            /* the file is zero-filled, so every slot starts unused. */
+            auto *r = static_cast<region*>(addr);
+            r->head.version = FORMAT_VERSION;
+            r->head.nslots = MAX_NODES;
+            r->head.size = sizeof(region);
+            r->head.pid = getpid();
+            r->head.started = now_ms();
+            copy_name(r->head.component, sizeof(r->head.component), component);
+            /* readers check the magic last. */
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(r->head.magic, MAGIC, sizeof(MAGIC));
+            shared = r;
+            shared_path = path;
+        }
+        void close() {
+            if(!shared)
+                return;
+            munmap(shared, sizeof(region));
+            unlink(shared_path.c_str());
+            shared = nullptr;
+            shared_path.clear();
+        }
+        void attach(const std::string& service) {
+            if(!shared || local_slot)
+                return;
+            for(auto& s: shared->slots) {
+                std::uint32_t unused = 0;
+                if(s.used.compare_exchange_strong(unused, 1, std::memory_order_acq_rel)) {
+                    node_record rec{};
+                    copy_name(rec.service, sizeof(rec.service), service);
+                    rec.tid = syscall(SYS_gettid);
+                    rec.updated = now_ms();
+                    publish(s, rec);
+                    local_slot = &s;
+                    loop_metrics::timing() = true;
+                    return;
+                }
+            }
+        }
+        void detach() {
+            if(auto *s = local_slot) {
+                s->used.store(0, std::memory_order_release);
+                local_slot = nullptr;
+                loop_metrics::timing() = false;
+            }
+        }
+        slot *local() {
+            return local_slot;
+        }
+        node_record& begin(slot& s) {
+            s.seq.store(s.seq.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            return s.record;
+        }
+        void end(slot& s) {
+            s.seq.store(s.seq.load(std::memory_order_relaxed)+1, std::memory_order_release);
+        }
+        /* records are copied in and out of the file as bytes. */
+        static_assert(std::is_trivially_copyable_v<node_record>);
+        void publish(slot& s, const node_record& rec) {
+            std::memcpy(&begin(s), &rec, sizeof(rec));
+            end(s);
+        }
+        bool read(const slot& s, node_record& rec) {
+            constexpr int RETRIES = 1000;
+            for(int i=0; i < RETRIES; ++i) {
+                if(!s.used.load(std::memory_order_acquire))
+                    return false;
+                const auto seq = s.seq.load(std::memory_order_acquire);
+                if(seq & 1)
+                    continue;
+                /* only the backends in use are copied, the record is *
+                 * trivially copyable so a partial copy is fine.      */
+                std::memcpy(static_cast<void*>(&rec), &s.record, offsetof(node_record, backends));
+                const auto n = std::min<std::uint64_t>(rec.nbackends, MAX_BACKENDS);
+                std::memcpy(rec.backends, s.record.backends, n*sizeof(backend_record));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(s.seq.load(std::memory_order_relaxed) == seq)
+                    return true;
+            }
+            return false;
+        }
+        reader::reader(const std::string& path):
+            _path{path}, _region{nullptr}
+        {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd < 0)
+                throw_system_error("Unable to open statistics file: " + path);
+            struct stat st = {};
+            if(fstat(fd, &st)) {
+                ::close(fd);
+                throw_system_error("Unable to stat statistics file: " + path);
+            }
+            if(static_cast<std::size_t>(st.st_size) < sizeof(region)) {
+                ::close(fd);
+                throw std::invalid_argument("Invalid statistics file: " + path);
+            }
+            void *addr = mmap(nullptr, sizeof(region), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if(addr == MAP_FAILED)
+                throw_system_error("Unable to map statistics file: " + path);
+            const auto *r = static_cast<const region*>(addr);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(std::memcmp(r->head.magic, MAGIC, sizeof(MAGIC)) ||
+                    r->head.version != FORMAT_VERSION ||
+                    r->head.size != sizeof(region) ||
+                    r->head.nslots != MAX_NODES
+            ){
+                munmap(addr, sizeof(region));
+                throw std::invalid_argument("Invalid statistics file: " + path);
+            }
+            _region = r;
+        }
+        bool reader::alive() const {
+            return !kill(head().pid, 0) || errno == EPERM;
+        }
+        reader::~reader() {
+            munmap(const_cast<region*>(_region), sizeof(region));
+        }
+    }
+}
@@ -0,0 +1,146 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "../metrics/metrics_loop.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#pragma once
+#ifndef CLOUDBUS_STATS
+#define CLOUDBUS_STATS
+namespace cloudbus {
+    /* Node threads publish their counters into a file that   *
+     * is shared with any number of readers through mmap().    *
+     * Each node owns one slot and is its only writer, so the  *
+     * slots are guarded by seqlocks: a reader copies the slot *
+     * and retries if the sequence moved while it was copying. *
+     * Readers map the file read-only and never write to it,   *
+     * so reading costs the writing threads nothing.            */
+    namespace stats {
+        inline constexpr char MAGIC[8] = {'C', 'B', 'S', 'T', 'A', 'T', 'S', '\0'};
+        /* bump whenever the layout below changes. */
+        inline constexpr std::uint32_t FORMAT_VERSION = 4;
+        inline constexpr std::size_t MAX_NODES = 256;
+        inline constexpr std::size_t MAX_BACKENDS = 16;
+        inline constexpr std::size_t NAMELEN = 64;
+        /* nodes publish at most once per interval. */
+        inline constexpr std::int64_t INTERVAL_MS = 1000;
+        enum states {HALF_OPEN, OPEN, HALF_CLOSED, CLOSED, NSTATES};
+        /* a completed session split at its timestamps: waiting for the  *
+         * first bytes to leave (DNS, connect and the transport queue),  *
+         * uploading the rest of the request, waiting on the backend and *
+         * downloading the response.                                     */
+        enum phases {CONNECT, UPLOAD, THINK, DOWNLOAD, NPHASES};
+
+        struct backend_record {
+            char uri[NAMELEN];
+            std::uint64_t streams, outstanding;
+            /* moving averages over the measured streams, in milliseconds. */
+            std::uint64_t interarrival, intercompletion;
+            /* time to the first response byte and session duration. */
+            histogram ttfb, duration;
+        };
+        struct node_record {
+            char service[NAMELEN];
+            std::uint64_t tid;
+            /* unix time of the last publish, in milliseconds. */
+            std::uint64_t updated;
+            std::uint64_t arrivals;
+            std::uint64_t sessions[NSTATES];
+            /* payload bytes routed from the north and from the south. */
+            std::uint64_t north_bytes, south_bytes;
+            std::uint64_t pool_hits, pool_misses;
+            histogram phases[NPHASES];
+            /* sessions slower than the service's slow_session. */
+            std::uint64_t slow;
+            /* CPU time of the thread in user space and in the kernel. */
+            std::uint64_t user_us, system_us;
+            loop_metrics loop;
+            std::uint64_t nbackends;
+            backend_record backends[MAX_BACKENDS];
+        };
+        struct slot {
+            /* odd while the record is being written. */
+            std::atomic<std::uint32_t> seq;
+            std::atomic<std::uint32_t> used;
+            node_record record;
+        };
+        struct header {
+            char magic[sizeof(MAGIC)];
+            std::uint32_t version;
+            std::uint32_t nslots;
+            std::uint64_t size;
+            std::int64_t pid;
+            /* unix time the process started, in milliseconds. */
+            std::uint64_t started;
+            char component[16];
+        };
+        struct region {
+            header head;
+            slot slots[MAX_NODES];
+        };
+        static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+            "the seqlocks must be address-free to be shared across processes.");
+
+        /* /dev/shm/cloudbus-<component>.<pid> */
+        std::string default_path(const std::string& component, pid_t pid);
+        /* Creates and maps the statistics file of this process. */
+        void open(const std::string& path, const std::string& component);
+        /* Unmaps and removes the statistics file. */
+        void close();
+        /* Claims a slot for the calling thread's node and  *
+         * switches on loop_metrics::timing(), a no-op if no *
+         * statistics file is open.                          */
+        void attach(const std::string& service);
+        void detach();
+        /* The calling thread's slot, or nullptr. */
+        slot *local();
+        /* Brackets the writes of the owner of s to its record. */
+        node_record& begin(slot& s);
+        void end(slot& s);
+        /* Writes rec into s, only ever called by the owner of s. */
+        void publish(slot& s, const node_record& rec);
+        /* Copies s into rec up to its last backend, *
+         * false if s is unused or kept changing.     */
+        bool read(const slot& s, node_record& rec);
+
+        /* Maps a statistics file read-only. */
+        class reader {
+            public:
+                explicit reader(const std::string& path);
+
+                const std::string& path() const { return _path; }
+                const header& head() const { return _region->head; }
+                const slot& operator[](std::size_t i) const { return _region->slots[i]; }
+                std::size_t size() const { return _region->head.nslots; }
+                /* false once the process that owns the file has exited. */
+                bool alive() const;
+
+                ~reader();
+
+                reader() = delete;
+                reader(const reader& other) = delete;
+                reader& operator=(const reader& other) = delete;
+                reader(reader&& other) = delete;
+                reader& operator=(reader&& other) = delete;
+
+            private:
+                std::string _path;
+                const region *_region;
+        };
+    }
+}
+#endif
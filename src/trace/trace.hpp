@@ -0,0 +1,43 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#ifndef CLOUDBUS_TRACE
+#define CLOUDBUS_TRACE
+/* USDT probes on the forwarding path, for bpftrace or perf:        *
+ *                                                                  *
+ *   cloudbus:accept(fd)                                            *
+ *   cloudbus:session_create(uuid, north fd, south fd)              *
+ *   cloudbus:session_state(uuid, from, to)                         *
+ *   cloudbus:frame_enqueue(uuid, fd, length)                       *
+ *   cloudbus:frame_dequeue(uuid, fd, length)                       *
+ *   cloudbus:send(fd, bytes)                                       *
+ *   cloudbus:recv(fd, bytes)                                       *
+ *   cloudbus:resolve_start(interface, name)                        *
+ *   cloudbus:resolve_done(interface, ares status)                  *
+ *                                                                  *
+ * uuid points to the 16 bytes of the session's uuid, which is the  *
+ * same on the controller and the segment. Sockets are shared by    *
+ * sessions, so send and recv are joined to sessions through the    *
+ * fds of session_create. A probe is a nop until a tracer attaches  *
+ * to it, so they are compiled in whenever <sys/sdt.h> is there.    *
+ * Define CLOUDBUS_NO_TRACE to compile them out.                    */
+#if !defined(CLOUDBUS_NO_TRACE) && __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define CLOUDBUS_PROBE(name, ...) STAP_PROBEV(cloudbus, name, __VA_ARGS__)
+#else
+#define CLOUDBUS_PROBE(name, ...) do {} while(0)
+#endif
+#endif
@@ -16,7 +16,9 @@
 */
 #include "tests.hpp"
 #include "../src/connectors.hpp"
+#include <array>
 #include <thread>
+#include <sys/socket.h>
 using namespace cloudbus;
 static int test_timer_initial_state() {
     TimerQueue tq;
@@ -167,6 +169,161 @@ static int test_timer_no_events_processed_if_not_expired() {
     return TEST_PASS;
 }
 
+static int test_timer_cascade_and_cancel() {
+    using milliseconds = std::chrono::milliseconds;
+    TimerQueue tq;
+    const auto now = std::chrono::steady_clock::now();
+    FAIL_IF(tq.next() != TimerQueue::TimePoint::max());
+    std::vector<int> order;
+    std::vector<std::shared_ptr<interface_base::stream_type> > streams;
+    /* one timer on each level of the wheel. */
+    for(int ms: {300000, 70000, 1000, 100}) {
+        streams.push_back(std::make_shared<interface_base::stream_type>());
+        tq.addEvent(streams.back(), now+milliseconds(ms), [&, ms](){ order.push_back(ms); });
+    }
+    FAIL_IF(tq.size() != 4);
+    FAIL_IF(tq.next() > now+milliseconds(101));
+    /* rescheduling does not add a timer. */
+    tq.addEvent(streams[2], now+milliseconds(2000), [&](){ order.push_back(-1); });
+    FAIL_IF(tq.size() != 4);
+    FAIL_IF(tq.processEvents(now+milliseconds(1500)) != 1);
+    FAIL_IF(tq.next() > now+milliseconds(2001));
+    FAIL_IF(tq.processEvents(now+milliseconds(2001)) != 1);
+    FAIL_IF(!tq.cancel(streams[1]));
+    FAIL_IF(tq.cancel(streams[1]));
+    FAIL_IF(tq.processEvents(now+milliseconds(299000)) != 0);
+    FAIL_IF(tq.processEvents(now+milliseconds(300001)) != 1);
+    FAIL_IF(order != std::vector<int>({100, 1000, 300000}));
+    FAIL_IF(tq.size() != 0);
+    return TEST_PASS;
+}
+
+static int test_sessions_index() {
+    using connection_type = connector_base::connection_type;
+    connector_base::connections_type sessions;
+    auto north = std::make_shared<interface_base::stream_type>();
+    auto south1 = std::make_shared<interface_base::stream_type>();
+    auto south2 = std::make_shared<interface_base::stream_type>();
+    auto uuid1 = messages::make_uuid_v7(), uuid2 = messages::make_uuid_v7();
+    sessions.insert(connection_type::make(uuid1, north, south1, connection_type::HALF_OPEN));
+    sessions.insert(connection_type::make(uuid1, north, south2, connection_type::HALF_OPEN));
+    sessions.insert(connection_type::make(uuid2, north, south1, connection_type::OPEN));
+    FAIL_IF(sessions.size() != 3);
+
+    std::vector<messages::uuid> order;
+    for(auto& c: sessions.north(north))
+        order.push_back(c.uuid);
+    FAIL_IF(order != std::vector<messages::uuid>({uuid1, uuid1, uuid2}));
+    FAIL_IF(std::distance(sessions.south(south1).begin(), sessions.south(south1).end()) != 2);
+    FAIL_IF(std::distance(sessions.uuid(uuid1).begin(), sessions.uuid(uuid1).end()) != 2);
+    FAIL_IF(!sessions.south(std::make_shared<interface_base::stream_type>()).empty());
+
+    /* erase returns the next session on the same list. */
+    auto range = sessions.south(south1);
+    auto it = sessions.erase(range.begin());
+    FAIL_IF(it == range.end() || it->uuid != uuid2);
+    FAIL_IF(sessions.size() != 2);
+    FAIL_IF(sessions.uuid(uuid1).begin()->south.lock() != south2);
+    FAIL_IF(sessions.erase(it) != range.end());
+    FAIL_IF(!sessions.south(south1).empty() || !sessions.uuid(uuid2).empty());
+    FAIL_IF(sessions.north(north).begin()->south.lock() != south2);
+    FAIL_IF(sessions.begin()->uuid != uuid1 || ++sessions.begin() != sessions.end());
+
+    sessions.erase(sessions.begin());
+    FAIL_IF(!sessions.empty() || !sessions.north(north).empty());
+    return TEST_PASS;
+}
+
+static int test_session_phases() {
+    using connection_type = connector_base::connection_type;
+    using milliseconds = std::chrono::milliseconds;
+    const config::section section = {
+        {"bind", "tcp://127.0.0.1:0"},
+        {"backend", "tcp://127.0.0.1:9"},
+        {"slow_session", "50"}
+    };
+    connector_base c(section);
+    FAIL_IF(c.slow() != milliseconds(50));
+
+    /* only the sessions that were waiting are marked as sent. */
+    auto north = std::make_shared<interface_base::stream_type>();
+    auto south = std::make_shared<interface_base::stream_type>();
+    const auto t0 = connection_type::clock_type::now();
+    auto first = c.connections().insert(connection_type::make(messages::make_uuid_v7(), north, south, connection_type::HALF_OPEN, t0));
+    c.sent(south);
+    const auto sent = first->timestamps->at(connection_type::SENT);
+    FAIL_IF(sent == connection_type::time_point());
+    auto second = c.connections().insert(connection_type::make(messages::make_uuid_v7(), north, south, connection_type::HALF_OPEN, t0));
+    std::this_thread::sleep_for(milliseconds(1));
+    c.sent(south);
+    FAIL_IF(first->timestamps->at(connection_type::SENT) != sent);
+    FAIL_IF(second->timestamps->at(connection_type::SENT) <= sent);
+
+    /* sessions that never responded are left out. */
+    auto& times = *first->timestamps;
+    times[connection_type::CLOSED] = t0 + milliseconds(5);
+    c.complete(*first);
+    FAIL_IF(c.phases()[stats::CONNECT].count() != 0);
+
+    /* a request that was sent whole has no upload phase. */
+    times[connection_type::SENT] = t0 + milliseconds(1);
+    times[connection_type::REQUEST] = t0;
+    times[connection_type::RESPONSE] = t0 + milliseconds(11);
+    times[connection_type::CLOSED] = t0 + milliseconds(61);
+    c.complete(*first);
+    for(const auto& h: c.phases())
+        FAIL_IF(h.count() != 1);
+    FAIL_IF(c.phases()[stats::CONNECT].percentile(50) < 1000 || c.phases()[stats::CONNECT].percentile(50) > 1100);
+    FAIL_IF(c.phases()[stats::UPLOAD].percentile(50) != 0);
+    FAIL_IF(c.phases()[stats::THINK].percentile(50) < 10000 || c.phases()[stats::THINK].percentile(50) > 11000);
+    FAIL_IF(c.phases()[stats::DOWNLOAD].percentile(50) < 50000 || c.phases()[stats::DOWNLOAD].percentile(50) > 55000);
+    FAIL_IF(c.slow_sessions() != 1);
+
+    /* a response before the request has finished clamps to it. */
+    times[connection_type::REQUEST] = t0 + milliseconds(20);
+    times[connection_type::CLOSED] = t0 + milliseconds(30);
+    c.complete(*first);
+    FAIL_IF(c.phases()[stats::THINK].count() != 2 || c.slow_sessions() != 1);
+
+    try {
+        connector_base bad({
+            {"bind", "tcp://127.0.0.1:0"},
+            {"backend", "tcp://127.0.0.1:9"},
+            {"slow_session", "-1"}
+        });
+        FAIL_IF(true);
+    } catch(const std::invalid_argument& e) {}
+    return TEST_PASS;
+}
+
+static int test_lookup_index() {
+    const config::section section = {
+        {"bind", "tcp://127.0.0.1:0"},
+        {"backend", "tcp://127.0.0.1:9"}
+    };
+    connector_base c(section);
+    connector_base::interface_type *interface = nullptr;
+    interface_base::handle_type hnd;
+    auto& south = c.south().front();
+    std::array<int, 2> sv{};
+    FAIL_IF(socketpair(AF_UNIX, SOCK_STREAM, 0, sv.data()));
+    c.index(south.make(sv[0], true), south);
+    FAIL_IF(c.lookup(sv[0], interface, hnd) != connector_base::SOUTH);
+    FAIL_IF(interface != &south || std::get<interface_base::native_handle_type>(hnd) != sv[0]);
+
+    /* entries of erased streams are dropped. */
+    south.erase(hnd);
+    hnd = interface_base::handle_type();
+    FAIL_IF(c.lookup(sv[0], interface, hnd) != connector_base::NONE);
+
+    /* a stream that was never indexed is not searched for. */
+    south.make(sv[1], true);
+    FAIL_IF(c.lookup(sv[1], interface, hnd) != connector_base::NONE);
+    FAIL_IF(c.lookup(-1, interface, hnd) != connector_base::NONE);
+    FAIL_IF(c.lookup(1 << 20, interface, hnd) != connector_base::NONE);
+    return TEST_PASS;
+}
+
 int main(int argc, char **argv) {
     std::cout << "================================ TEST CONNECTOR ================================" << std::endl;
     EXEC_TEST(test_timer_initial_state);
@@ -176,6 +333,10 @@ int main(int argc, char **argv) {
     EXEC_TEST(test_timer_multiple_events_expire_together);
     EXEC_TEST(test_timer_callback_handles_expired_stream_ptr);
     EXEC_TEST(test_timer_no_events_processed_if_not_expired);
+    EXEC_TEST(test_timer_cascade_and_cancel);
+    EXEC_TEST(test_sessions_index);
+    EXEC_TEST(test_session_phases);
+    EXEC_TEST(test_lookup_index);
     std::cout << "================================================================================" << std::endl;
     return TEST_PASS;
 }
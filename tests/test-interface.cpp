@@ -159,11 +159,56 @@ static int test_streams() {
         FAIL_IF(std::get<weight_type>(addr).count != 1);
     return TEST_PASS;
 }
+static int test_loads() {
+    using namespace cloudbus;
+    using load_type = interface_base::load_type;
+    using duration_type = load_type::duration_type;
+    using stream_ptr = interface_base::stream_ptr;
+
+    interface_base base{"test.localhost:8080", "TCP"};
+    for(int i=0; i < 3; ++i)
+        base.make();
+    FAIL_IF(base.loads().size() != 3);
+    const stream_ptr sp = std::get<stream_ptr>(base.streams()[1]);
+    auto& load = base.load(base.streams()[1]);
+    FAIL_IF(load.measured);
+    auto t = load_type::clock_type::now();
+    FAIL_IF(load.arrival(t).count() != 0);
+    t += duration_type(100);
+    FAIL_IF(load.arrival(t).count() != 50);
+    FAIL_IF(load.outstanding != 2);
+    FAIL_IF(load.completion(t).count() != 50);
+    FAIL_IF(load.outstanding != 1);
+    /* the load follows its stream as streams come and go. */
+    base.make();
+    base.erase(base.streams().front());
+    auto *found = base.load(std::weak_ptr(sp));
+    FAIL_IF(!found);
+    FAIL_IF(found->interarrival.count() != 50);
+    FAIL_IF(base.loads().size() != base.streams().size());
+    auto other = std::make_shared<interface_base::stream_type>();
+    FAIL_IF(base.load(std::weak_ptr(other)) != nullptr);
+    /* latencies are kept for the stream and for the interface. */
+    FAIL_IF(found->latency);
+    base.record(*found, &interface_base::latency_type::ttfb, std::chrono::microseconds(250));
+    FAIL_IF(!found->latency || found->latency->ttfb.count() != 1);
+    FAIL_IF(found->latency->duration.count() != 0);
+    for(auto& hnd: base.streams())
+        if(std::get<stream_ptr>(hnd) == sp) {
+            base.erase(hnd);
+            break;
+        }
+    FAIL_IF(base.load(std::weak_ptr(sp)) != nullptr);
+    FAIL_IF(base.latency().ttfb.count() != 1);
+    FAIL_IF(base.latency().ttfb.percentile(50) != 255);
+    return TEST_PASS;
+}
 int main(int argc, char **argv) {
     std::cout << "=============================== TEST INTERFACES ================================" << std::endl;
     EXEC_TEST(test_construct);
     EXEC_TEST(test_addresses);
     EXEC_TEST(test_streams);
+    EXEC_TEST(test_loads);
     std::cout << "================================================================================" << std::endl;
     return TEST_PASS;
 }
\ No newline at end of file
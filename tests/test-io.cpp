@@ -0,0 +1,540 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "tests.hpp"
+#include "../src/io.hpp"
+#include "../src/io/pool.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <unistd.h>
+using namespace io;
+static int test_trigger_set_clear(int backend) {
+    trigger triggers(backend);
+    std::array<int, 2> p{};
+    FAIL_IF(pipe(p.data()));
+    FAIL_IF(triggers.set(p[0], POLLIN) == trigger::npos);
+    FAIL_IF(triggers.interest(p[0]) != POLLIN);
+    FAIL_IF(triggers.wait() != 0);
+    FAIL_IF(write(p[1], "x", 1) != 1);
+    FAIL_IF(triggers.wait() != 1);
+    std::size_t ready = 0;
+    for(const auto& e: triggers.events()) {
+        if(e.revents) {
+            FAIL_IF(e.fd != p[0]);
+            FAIL_IF(!(e.revents & POLLIN));
+            FAIL_IF(e.events != POLLIN);
+            ++ready;
+        }
+    }
+    FAIL_IF(ready != 1);
+    FAIL_IF(triggers.clear(p[0], POLLIN) == trigger::npos);
+    FAIL_IF(triggers.interest(p[0]) != 0);
+    FAIL_IF(triggers.clear(p[0]) != trigger::npos);
+    FAIL_IF(triggers.wait() != 0);
+    close(p[0]);
+    close(p[1]);
+    return TEST_PASS;
+}
+static int test_poll_trigger_set_clear() {
+    return test_trigger_set_clear(trigger::POLL);
+}
+static int test_trigger_update(int backend) {
+    trigger triggers(backend);
+    std::array<int, 2> p{};
+    FAIL_IF(pipe(p.data()));
+    FAIL_IF(triggers.set(p[1], POLLIN) == trigger::npos);
+    FAIL_IF(triggers.wait() != 0);
+    FAIL_IF(triggers.set(p[1], POLLOUT) == trigger::npos);
+    FAIL_IF(triggers.interest(p[1]) != (POLLIN | POLLOUT));
+    FAIL_IF(triggers.wait() != 1);
+    FAIL_IF(triggers.events().size() != 1);
+    FAIL_IF(!(triggers.events().front().revents & POLLOUT));
+    FAIL_IF(triggers.clear(p[1], POLLOUT) == trigger::npos);
+    FAIL_IF(triggers.wait() != 0);
+    FAIL_IF(!triggers.events().empty());
+    close(p[0]);
+    close(p[1]);
+    return TEST_PASS;
+}
+static int test_trigger_ready_only(int backend) {
+    constexpr std::size_t NPIPES = 16;
+    trigger triggers(backend);
+    std::array<std::array<int, 2>, NPIPES> pipes{};
+    for(auto& p: pipes) {
+        FAIL_IF(pipe(p.data()));
+        FAIL_IF(triggers.set(p[0], POLLIN) == trigger::npos);
+    }
+    FAIL_IF(write(pipes[3][1], "x", 1) != 1);
+    FAIL_IF(write(pipes[11][1], "x", 1) != 1);
+    FAIL_IF(triggers.wait() != 2);
+    const auto& events = triggers.events();
+    FAIL_IF(events.size() != 2);
+    FAIL_IF(events[0].fd > events[1].fd);
+    for(const auto& e: events)
+        FAIL_IF(e.fd != pipes[3][0] && e.fd != pipes[11][0]);
+    for(auto& p: pipes) {
+        triggers.clear(p[0]);
+        close(p[0]);
+        close(p[1]);
+    }
+    return TEST_PASS;
+}
+static int test_trigger_recycled_handle(int backend) {
+    trigger triggers(backend);
+    std::array<int, 2> p{};
+    FAIL_IF(pipe(p.data()));
+    FAIL_IF(triggers.set(p[0], POLLIN) == trigger::npos);
+    /* the handle is closed and recycled without being cleared. */
+    close(p[0]);
+    close(p[1]);
+    FAIL_IF(pipe(p.data()));
+    FAIL_IF(triggers.set(p[0], POLLOUT) == trigger::npos);
+    FAIL_IF(write(p[1], "x", 1) != 1);
+    FAIL_IF(triggers.wait() != 1);
+    close(p[0]);
+    close(p[1]);
+    return TEST_PASS;
+}
+static int test_epoll_trigger_set_clear() {
+    return test_trigger_set_clear(trigger::EPOLL);
+}
+static int test_epoll_trigger_update() {
+    return test_trigger_update(trigger::EPOLL);
+}
+static int test_epoll_trigger_ready_only() {
+    return test_trigger_ready_only(trigger::EPOLL);
+}
+static int test_epoll_trigger_recycled_handle() {
+    return test_trigger_recycled_handle(trigger::EPOLL);
+}
+static int test_uring_trigger_set_clear() {
+    return test_trigger_set_clear(trigger::URING);
+}
+static int test_uring_trigger_update() {
+    return test_trigger_update(trigger::URING);
+}
+static int test_uring_trigger_ready_only() {
+    return test_trigger_ready_only(trigger::URING);
+}
+static int test_uring_trigger_recycled_handle() {
+    return test_trigger_recycled_handle(trigger::URING);
+}
+static short wait_for(trigger& triggers, int fd, short mask) {
+    for(int i=0; i < 100; ++i) {
+        if(triggers.wait(std::chrono::milliseconds(10)) == trigger::npos)
+            return 0;
+        for(const auto& e: triggers.events()) {
+            if(e.fd == fd && (e.revents & mask))
+                return e.revents;
+        }
+    }
+    return 0;
+}
+static int test_uring_sockbuf_io() {
+    trigger triggers(trigger::URING);
+    /* the first poll makes the ring do the socket I/O of this thread. */
+    FAIL_IF(triggers.wait() != 0);
+    if(!uring_poller::local())
+        return TEST_SKIP;
+    std::array<int, 2> sv{};
+    FAIL_IF(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv.data()));
+    {
+        streams::sockstream s(sv[0], true);
+        FAIL_IF(triggers.set(sv[0], POLLIN | POLLOUT) == trigger::npos);
+        FAIL_IF(!(wait_for(triggers, sv[0], POLLOUT) & POLLOUT));
+        FAIL_IF(write(sv[1], "hello", 5) != 5);
+        FAIL_IF(!(wait_for(triggers, sv[0], POLLIN) & POLLIN));
+        std::array<char, 16> buf{};
+        FAIL_IF(s.readsome(buf.data(), buf.size()) != 5);
+        FAIL_IF(std::string(buf.data(), 5) != "hello");
+        /* the shutdown is not allowed to overtake the send. */
+        std::string payload(poll_traits<uring_t>::MAX_SEND, 'x');
+        for(std::size_t i=0; i < payload.size(); ++i)
+            payload[i] = static_cast<char>(i);
+        FAIL_IF(s.write(payload.data(), payload.size()).flush().bad());
+        /* sends queue behind the one in flight. */
+        for(int i=0; i < 10 && s.tellp() != 0; ++i) {
+            FAIL_IF(!(wait_for(triggers, sv[0], POLLOUT) & POLLOUT));
+            FAIL_IF(s.flush().bad());
+        }
+        FAIL_IF(s.tellp() != 0);
+        FAIL_IF(s.shutdown(SHUT_WR));
+        std::string received;
+        std::array<char, 4096> rbuf{};
+        for(int i=0; i < 1000; ++i) {
+            ssize_t len = read(sv[1], rbuf.data(), rbuf.size());
+            if(!len)
+                break;
+            FAIL_IF(len < 0 && errno != EAGAIN);
+            if(len < 0) {
+                /* the rest is sent and shut down as the ring is polled. */
+                FAIL_IF(triggers.wait(std::chrono::milliseconds(10)) == trigger::npos);
+            } else received.append(rbuf.data(), len);
+        }
+        FAIL_IF(received != payload);
+        FAIL_IF(!(wait_for(triggers, sv[0], POLLOUT) & POLLOUT));
+        close(sv[1]);
+        FAIL_IF(!(wait_for(triggers, sv[0], POLLIN) & POLLIN));
+        FAIL_IF(s.readsome(buf.data(), buf.size()) != 0);
+        FAIL_IF(!s.eof());
+        FAIL_IF(triggers.clear(sv[0]) == trigger::npos);
+    }
+    /* the socket is closed by the ring once its shutdown is done. */
+    for(int i=0; i < 100 && fcntl(sv[0], F_GETFD) != -1; ++i)
+        FAIL_IF(triggers.wait(std::chrono::milliseconds(10)) == trigger::npos);
+    FAIL_IF(fcntl(sv[0], F_GETFD) != -1);
+    return TEST_PASS;
+}
+static int test_uring_sockbuf_accept() {
+    trigger triggers(trigger::URING);
+    FAIL_IF(triggers.wait() != 0);
+    if(!uring_poller::local())
+        return TEST_SKIP;
+    int lfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    FAIL_IF(lfd < 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    FAIL_IF(bind(lfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen));
+    FAIL_IF(listen(lfd, 8));
+    FAIL_IF(getsockname(lfd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen));
+    streams::sockstream ls(lfd);
+    FAIL_IF(triggers.set(lfd, POLLIN) == trigger::npos);
+    int cfd = socket(AF_INET, SOCK_STREAM, 0);
+    FAIL_IF(cfd < 0);
+    FAIL_IF(connect(cfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen));
+    FAIL_IF(write(cfd, "ping", 4) != 4);
+    int afd = -1;
+    for(int i=0; i < 10 && afd < 0; ++i) {
+        FAIL_IF(!(wait_for(triggers, lfd, POLLIN) & POLLIN));
+        afd = ls.accept();
+        FAIL_IF(afd < 0 && errno != EAGAIN);
+    }
+    FAIL_IF(afd < 0);
+    FAIL_IF(!(fcntl(afd, F_GETFL) & O_NONBLOCK));
+    FAIL_IF(!(fcntl(afd, F_GETFD) & FD_CLOEXEC));
+    {
+        /* bytes that arrived before the stream was polled are kept. */
+        streams::sockstream as(afd, true);
+        FAIL_IF(triggers.set(afd, POLLIN) == trigger::npos);
+        FAIL_IF(!(wait_for(triggers, afd, POLLIN) & POLLIN));
+        std::array<char, 16> buf{};
+        FAIL_IF(as.readsome(buf.data(), buf.size()) != 4);
+        FAIL_IF(std::string(buf.data(), 4) != "ping");
+        FAIL_IF(as.write("pong", 4).flush().bad());
+        FAIL_IF(triggers.wait() == trigger::npos);
+        FAIL_IF(read(cfd, buf.data(), buf.size()) != 4);
+        FAIL_IF(std::string(buf.data(), 4) != "pong");
+        FAIL_IF(triggers.clear(afd) == trigger::npos);
+    }
+    FAIL_IF(triggers.clear(lfd) == trigger::npos);
+    close(cfd);
+    return TEST_PASS;
+}
+static std::size_t drain(int fd, std::string& received) {
+    std::array<char, 65536> buf{};
+    ssize_t len = 0;
+    while((len = read(fd, buf.data(), buf.size())) > 0)
+        received.append(buf.data(), len);
+    return received.size();
+}
+static int test_sockbuf_segments() {
+    using buffers::sockbuf;
+    std::array<int, 2> sv{};
+    FAIL_IF(socketpair(AF_UNIX, SOCK_STREAM, 0, sv.data()));
+    FAIL_IF(fcntl(sv[1], F_SETFL, O_NONBLOCK));
+    int sndbuf = 4096;
+    FAIL_IF(setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)));
+    std::string payload(3*sockbuf::MIN_BUFSIZE+1000, 'x');
+    for(std::size_t i=0; i < payload.size(); ++i)
+        payload[i] = static_cast<char>(i*131+7);
+    std::string received;
+    {
+        streams::sockstream s(sv[0], true);
+        auto *sb = dynamic_cast<sockbuf*>(s.rdbuf());
+        /* filling a segment flushes, the kernel takes part of it. */
+        FAIL_IF(s.write(payload.data(), payload.size()).bad());
+        FAIL_IF(drain(sv[1], received)+s.tellp() != payload.size());
+        const auto segments = sb->sendbuf()->segments.size();
+        FAIL_IF(segments < 3 || sb->sendbuf()->offset == 0);
+        /* rewinding drops the segments past the new end. */
+        const std::size_t rewind = static_cast<std::size_t>(s.tellp())-sockbuf::MIN_BUFSIZE-500;
+        FAIL_IF(!s.seekp(rewind));
+        FAIL_IF(static_cast<std::size_t>(s.tellp()) != rewind);
+        FAIL_IF(sb->sendbuf()->segments.size() >= segments);
+        const std::size_t written = received.size()+rewind;
+        FAIL_IF(s.write(payload.data()+written, payload.size()-written).bad());
+        FAIL_IF(drain(sv[1], received)+s.tellp() != payload.size());
+        /* partial sends resume from inside the first segment. */
+        int flushes = 0;
+        while(s.tellp() != 0) {
+            FAIL_IF(s.flush().bad());
+            FAIL_IF(drain(sv[1], received)+s.tellp() != payload.size());
+            FAIL_IF(++flushes > 10000);
+        }
+        FAIL_IF(flushes < 2);
+        FAIL_IF(sb->sendbuf()->offset != 0);
+        FAIL_IF(received != payload);
+
+        /* a backlog of more than IOV_MAX segments goes out in pieces. */
+        std::string large((IOV_MAX+64)*sockbuf::MIN_BUFSIZE, 'x');
+        for(std::size_t i=0; i < large.size(); ++i)
+            large[i] = static_cast<char>(i*131+7);
+        sndbuf = 1 << 20;
+        FAIL_IF(setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)));
+        FAIL_IF(s.write(large.data(), large.size()).bad());
+        FAIL_IF(sb->sendbuf()->segments.size() <= IOV_MAX);
+        received.clear();
+        for(flushes = 0; s.tellp() != 0; ++flushes) {
+            FAIL_IF(s.flush().bad());
+            drain(sv[1], received);
+            FAIL_IF(flushes > 100000);
+        }
+        drain(sv[1], received);
+        FAIL_IF(received != large);
+    }
+    close(sv[1]);
+    return TEST_PASS;
+}
+static int test_sockbuf_zerocopy() {
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    FAIL_IF(lfd < 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    FAIL_IF(bind(lfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen));
+    FAIL_IF(listen(lfd, 1));
+    FAIL_IF(getsockname(lfd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen));
+    int cfd = socket(AF_INET, SOCK_STREAM, 0);
+    FAIL_IF(cfd < 0);
+    FAIL_IF(connect(cfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen));
+    int afd = accept(lfd, nullptr, nullptr);
+    FAIL_IF(afd < 0);
+    close(lfd);
+
+    streams::sockstream s(cfd, true);
+    s.zerocopy() = 1;
+    std::string payload(4*buffers::sockbuf::MIN_BUFSIZE, 'x');
+    for(std::size_t i=0; i < payload.size(); ++i)
+        payload[i] = static_cast<char>(i);
+    s.write(payload.data(), payload.size());
+    std::string received;
+    std::array<char, 4096> buf{};
+    while(received.size() < payload.size()) {
+        FAIL_IF(s.flush().bad());
+        ssize_t len = read(afd, buf.data(), buf.size());
+        FAIL_IF(len <= 0);
+        received.append(buf.data(), len);
+    }
+    FAIL_IF(received != payload);
+    FAIL_IF(s.tellp() != 0);
+    /* The kernel acknowledges zerocopy sends on the error queue. */
+    struct pollfd pfd = {cfd, 0, 0};
+    int reaped = 0;
+    for(int i=0; i < 100 && !reaped; ++i) {
+        FAIL_IF(poll(&pfd, 1, 10) < 0);
+        if(pfd.revents & POLLERR)
+            FAIL_IF((reaped = s.reap()) < 0);
+    }
+    if(s.zerocopy())
+        FAIL_IF(reaped < 1);
+    close(afd);
+    return TEST_PASS;
+}
+static int test_sockbuf_zerocopy_unreaped() {
+    using buffers::pool;
+    using buffers::sockbuf;
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    FAIL_IF(lfd < 0);
+    /* a small window keeps the sends unacknowledged. */
+    int rcvbuf = 4096;
+    FAIL_IF(setsockopt(lfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    FAIL_IF(bind(lfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen));
+    FAIL_IF(listen(lfd, 1));
+    FAIL_IF(getsockname(lfd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen));
+    int cfd = socket(AF_INET, SOCK_STREAM, 0);
+    FAIL_IF(cfd < 0);
+    FAIL_IF(connect(cfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen));
+    int afd = accept(lfd, nullptr, nullptr);
+    FAIL_IF(afd < 0);
+    close(lfd);
+
+    std::vector<void*> inflight;
+    {
+        streams::sockstream s(cfd, true);
+        s.zerocopy() = 1;
+        std::string payload(4*sockbuf::MIN_BUFSIZE, 'x');
+        s.write(payload.data(), payload.size());
+        auto *sb = dynamic_cast<sockbuf*>(s.rdbuf());
+        std::vector<void*> written;
+        for(const auto& segment: sb->sendbuf()->segments)
+            written.push_back(segment.iov_base);
+        FAIL_IF(s.flush().bad());
+        if(!s.zerocopy()) {
+            close(afd);
+            return TEST_SKIP;
+        }
+        /* sent segments are retired, the leading zcsegs are in flight. */
+        const auto& buf = sb->sendbuf();
+        for(auto *ptr: written) {
+            auto it = std::find_if(buf->segments.begin(), buf->segments.end(),
+                [&](const auto& segment){ return segment.iov_base == ptr; });
+            if(it == buf->segments.end() || static_cast<std::size_t>(it-buf->segments.begin()) < buf->zcsegs)
+                inflight.push_back(ptr);
+        }
+        FAIL_IF(inflight.empty());
+    }
+    /* none of them may be handed out again by the pool. */
+    const auto& stats = pool::stats();
+    std::vector<void*> blocks;
+    for(int i=0; i < 64; ++i) {
+        const auto hits = stats.hits.load();
+        blocks.push_back(pool::allocate(sockbuf::MIN_BUFSIZE));
+        if(stats.hits.load() == hits)
+            break;
+        FAIL_IF(std::find(inflight.begin(), inflight.end(), blocks.back()) != inflight.end());
+    }
+    for(auto *ptr: blocks)
+        pool::deallocate(ptr, sockbuf::MIN_BUFSIZE);
+    close(afd);
+    return TEST_PASS;
+}
+static int test_sockbuf_zerocopy_unsupported() {
+    std::array<int, 2> sv{};
+    FAIL_IF(socketpair(AF_UNIX, SOCK_STREAM, 0, sv.data()));
+    streams::sockstream s(sv[0], true);
+    s.zerocopy() = 1;
+    FAIL_IF(s.write("hello", 5).flush().bad());
+    /* Unix sockets don't support SO_ZEROCOPY so sends copy. */
+    FAIL_IF(s.zerocopy() != 0);
+    FAIL_IF(s.reap() != 0);
+    std::array<char, 5> buf{};
+    FAIL_IF(read(sv[1], buf.data(), buf.size()) != 5);
+    FAIL_IF(std::string(buf.data(), buf.size()) != "hello");
+    close(sv[1]);
+    return TEST_PASS;
+}
+static int test_sockbuf_release() {
+    std::array<int, 2> sv{};
+    FAIL_IF(socketpair(AF_UNIX, SOCK_STREAM, 0, sv.data()));
+    streams::sockstream s(sv[0], true);
+    /* nothing is allocated before the first read or write. */
+    FAIL_IF(s.tellp() != 0);
+    FAIL_IF(!s.release());
+    FAIL_IF(write(sv[1], "ping", 4) != 4);
+    std::array<char, 4> buf{};
+    FAIL_IF(s.read(buf.data(), buf.size()).fail());
+    FAIL_IF(s.write("pong", 4).flush().fail());
+    /* active streams are released on the second call. */
+    FAIL_IF(s.release());
+    FAIL_IF(!s.release());
+    FAIL_IF(s.tellp() != 0);
+    FAIL_IF(read(sv[1], buf.data(), buf.size()) != 4);
+    FAIL_IF(std::string(buf.data(), buf.size()) != "pong");
+    FAIL_IF(write(sv[1], "ping", 4) != 4);
+    FAIL_IF(s.read(buf.data(), buf.size()).fail());
+    FAIL_IF(std::string(buf.data(), buf.size()) != "ping");
+    FAIL_IF(s.write("pong", 4).flush().fail());
+    FAIL_IF(read(sv[1], buf.data(), buf.size()) != 4);
+    /* unread input is never released. */
+    FAIL_IF(write(sv[1], "pingping", 8) != 8);
+    FAIL_IF(s.read(buf.data(), buf.size()).fail());
+    FAIL_IF(s.release());
+    FAIL_IF(s.release());
+    FAIL_IF(s.read(buf.data(), buf.size()).fail());
+    FAIL_IF(std::string(buf.data(), buf.size()) != "ping");
+    close(sv[1]);
+    return TEST_PASS;
+}
+static int test_pool_reuse() {
+    using buffers::pool;
+    const auto& stats = pool::stats();
+    void *ptr = pool::allocate(1000);
+    FAIL_IF(ptr == nullptr);
+    pool::deallocate(ptr, 1000);
+    const std::size_t hits = stats.hits, misses = stats.misses;
+    /* 1000 and 1024 bytes share a size class. */
+    void *again = pool::allocate(1024);
+    FAIL_IF(again != ptr);
+    FAIL_IF(stats.hits != hits+1);
+    FAIL_IF(stats.misses != misses);
+    void *other = pool::allocate(2048);
+    FAIL_IF(other == again);
+    FAIL_IF(stats.misses != misses+1);
+    pool::deallocate(other, 2048);
+    pool::deallocate(again, 1024);
+    /* oversized allocations bypass the cache. */
+    void *large = pool::allocate(pool::MAX_CLASS+1);
+    FAIL_IF(stats.misses != misses+2);
+    pool::deallocate(large, pool::MAX_CLASS+1);
+    return TEST_PASS;
+}
+static int test_pool_reallocate() {
+    using buffers::pool;
+    char *ptr = static_cast<char*>(pool::allocate(4096));
+    std::memset(ptr, 'x', 4096);
+    FAIL_IF(pool::reallocate(ptr, 4096, 3000) != ptr);
+    ptr = static_cast<char*>(pool::reallocate(ptr, 4096, 8192));
+    for(std::size_t i=0; i < 4096; ++i)
+        FAIL_IF(ptr[i] != 'x');
+    ptr = static_cast<char*>(pool::reallocate(ptr, 8192, 4*pool::MAX_CLASS));
+    for(std::size_t i=0; i < 4096; ++i)
+        FAIL_IF(ptr[i] != 'x');
+    pool::deallocate(ptr, 4*pool::MAX_CLASS);
+    return TEST_PASS;
+}
+static int test_pool_allocator() {
+    using buffers::pool;
+    const auto& stats = pool::stats();
+    auto sp = std::allocate_shared<buffers::socket_message>(buffers::pool_allocator<buffers::socket_message>());
+    sp.reset();
+    const std::size_t hits = stats.hits;
+    sp = std::allocate_shared<buffers::socket_message>(buffers::pool_allocator<buffers::socket_message>());
+    FAIL_IF(stats.hits != hits+1);
+    return TEST_PASS;
+}
+int main(int argc, char **argv) {
+    std::cout << "==================================== TEST IO ===================================" << std::endl;
+    EXEC_TEST(test_poll_trigger_set_clear);
+    EXEC_TEST(test_epoll_trigger_set_clear);
+    EXEC_TEST(test_epoll_trigger_update);
+    EXEC_TEST(test_epoll_trigger_ready_only);
+    EXEC_TEST(test_epoll_trigger_recycled_handle);
+    EXEC_TEST(test_uring_trigger_set_clear);
+    EXEC_TEST(test_uring_trigger_update);
+    EXEC_TEST(test_uring_trigger_ready_only);
+    EXEC_TEST(test_uring_trigger_recycled_handle);
+    EXEC_TEST(test_uring_sockbuf_io);
+    EXEC_TEST(test_uring_sockbuf_accept);
+    EXEC_TEST(test_sockbuf_segments);
+    EXEC_TEST(test_sockbuf_zerocopy);
+    EXEC_TEST(test_sockbuf_zerocopy_unreaped);
+    EXEC_TEST(test_sockbuf_zerocopy_unsupported);
+    EXEC_TEST(test_sockbuf_release);
+    EXEC_TEST(test_pool_reuse);
+    EXEC_TEST(test_pool_reallocate);
+    EXEC_TEST(test_pool_allocator);
+    std::cout << "================================================================================" << std::endl;
+    return TEST_PASS;
+}
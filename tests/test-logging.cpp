@@ -16,6 +16,8 @@
 #include "tests.hpp"
 #include "../src/logging.hpp"
 #include <sstream>
+#include <cerrno>
+#include <thread>
 using namespace cloudbus;
 static int test_logger_singleton() {
     Logger& logger1 = Logger::getInstance();
@@ -54,6 +56,7 @@ static int test_logger_filtering() {
     logger.info("info_msg_at_warn_level");   // Should not appear
     logger.warn("warn_msg_at_warn_level");   // Should appear
     logger.error("error_msg_at_warn_level"); // Should appear
+    logger.flush();
 
     std::string output = test_output.str();
     FAIL_IF(output.find("debug_msg_at_warn_level") != std::string::npos);
@@ -63,12 +66,14 @@ static int test_logger_filtering() {
 
     // Case 2: Log level WARNING
     logger.setLevel(Logger::Level::INFORMATIONAL); // This will add its own log line
+    logger.flush();
     test_output.str(""); // Clear stream *after* setLevel's own log
     
     logger.debug("debug_msg_at_info_level"); // Should not appear
     logger.info("info_msg_at_info_level");   // Should appear
     logger.warn("warn_msg_at_info_level");   // Should appear
     logger.error("error_msg_at_info_level"); // Should appear
+    logger.flush();
 
     output = test_output.str();
     FAIL_IF(output.find("debug_msg_at_info_level") != std::string::npos);
@@ -78,12 +83,14 @@ static int test_logger_filtering() {
 
     // Case 3: Log level DEBUG (all should appear)
     logger.setLevel(Logger::Level::DEBUG);
+    logger.flush();
     test_output.str(""); // Clear stream *after* setLevel's own log
 
     logger.debug("debug_msg_at_debug_level");
     logger.info("info_msg_at_debug_level");
     logger.warn("warn_msg_at_debug_level");
     logger.error("error_msg_at_debug_level");
+    logger.flush();
 
     output = test_output.str();
     FAIL_IF(output.find("debug_msg_at_debug_level") == std::string::npos);
@@ -91,6 +98,100 @@ static int test_logger_filtering() {
     FAIL_IF(output.find("warn_msg_at_debug_level") == std::string::npos);
     FAIL_IF(output.find("error_msg_at_debug_level") == std::string::npos);
 
+    Logger::resetOutputStream();
+    return TEST_PASS;
+}
+static int test_logger_drops() {
+    Logger& logger = Logger::getInstance();
+    std::stringstream test_output;
+    Logger::setOutputStream(test_output);
+    /* a thread that logs faster than the writer drains drops *
+     * records rather than blocking.                          */
+    const auto before = logger.dropped();
+    std::thread([&](){
+        for(int i=0; i < 100000; ++i)
+            logger.error("drop_msg");
+    }).join();
+    logger.flush();
+    FAIL_IF(logger.dropped() == before);
+    FAIL_IF(test_output.str().find("log records dropped") == std::string::npos);
+    /* a long message is truncated to one record. */
+    test_output.str("");
+    logger.error(std::string(4096, 'x'));
+    logger.flush();
+    FAIL_IF(test_output.str().find("...") == std::string::npos);
+    FAIL_IF(test_output.str().size() > 1024);
+    Logger::resetOutputStream();
+    return TEST_PASS;
+}
+static int test_logger_rate_limit() {
+    using rate_limit = Logger::rate_limit;
+    rate_limit limit;
+    std::size_t suppressed = 0;
+    auto now = rate_limit::clock_type::now();
+    for(std::size_t i=0; i < rate_limit::BURST; ++i)
+        FAIL_IF(!limit.allow(ECONNRESET, suppressed, now));
+    for(int i=0; i < 5; ++i)
+        FAIL_IF(limit.allow(ECONNRESET, suppressed, now));
+    /* other codes have their own bucket. */
+    FAIL_IF(!limit.allow(ECONNREFUSED, suppressed, now));
+    FAIL_IF(suppressed != 0);
+    now += rate_limit::INTERVAL;
+    FAIL_IF(!limit.allow(ECONNRESET, suppressed, now));
+    FAIL_IF(suppressed != 5);
+    FAIL_IF(limit.allow(ECONNRESET, suppressed, now));
+
+    Logger& logger = Logger::getInstance();
+    std::stringstream test_output;
+    Logger::setOutputStream(test_output);
+    {
+        rate_limit site;
+        for(std::size_t i=0; i < 2*rate_limit::BURST; ++i)
+            logger.log(Logger::Level::ERROR, site, ECONNRESET, [](){ return std::string("limited_msg"); });
+        logger.flush();
+        std::size_t lines = 0;
+        for(auto pos = test_output.str().find("limited_msg"); pos != std::string::npos; pos = test_output.str().find("limited_msg", pos+1))
+            ++lines;
+        FAIL_IF(lines != rate_limit::BURST);
+    }
+    /* the site logs what it still held back when it goes away. */
+    logger.flush();
+    FAIL_IF(test_output.str().find("10 similar messages suppressed after: limited_msg") == std::string::npos);
+    Logger::resetOutputStream();
+    return TEST_PASS;
+}
+static int test_logger_rate_limit_flush() {
+    using rate_limit = Logger::rate_limit;
+    Logger& logger = Logger::getInstance();
+    std::stringstream test_output;
+    Logger::setOutputStream(test_output);
+    {
+        rate_limit site;
+        for(std::size_t i=0; i < rate_limit::BURST+3; ++i)
+            logger.log(Logger::Level::ERROR, site, ECONNRESET, [](){ return std::string("storm_msg"); });
+        /* nothing is due until the bucket refills. */
+        auto now = rate_limit::clock_type::now();
+        FAIL_IF(rate_limit::flush_due() > now + rate_limit::INTERVAL);
+        rate_limit::flush(now);
+        logger.flush();
+        FAIL_IF(test_output.str().find("suppressed") != std::string::npos);
+        /* the storm is over, its count is logged on its own. */
+        rate_limit::flush(now + 2*rate_limit::INTERVAL);
+        logger.flush();
+        FAIL_IF(test_output.str().find("3 similar messages suppressed after: storm_msg") == std::string::npos);
+        FAIL_IF(rate_limit::flush_due() != rate_limit::time_point::max());
+
+        /* a code that takes over the oldest bucket starts afresh. */
+        now = rate_limit::clock_type::now();
+        std::size_t suppressed = 0;
+        for(int code=0; code < static_cast<int>(rate_limit::MAX_CODES); ++code)
+            for(std::size_t i=0; i < rate_limit::BURST+1; ++i)
+                site.allow(code+1000, suppressed, now);
+        FAIL_IF(!site.allow(2000, suppressed, now));
+        FAIL_IF(suppressed != 0);
+    }
+    logger.flush();
+    Logger::resetOutputStream();
     return TEST_PASS;
 }
 int main(int argc, char **argv) {
@@ -99,6 +200,9 @@ int main(int argc, char **argv) {
     EXEC_TEST(test_logger_default_level);
     EXEC_TEST(test_logger_set_and_get_level);
     EXEC_TEST(test_logger_filtering);
+    EXEC_TEST(test_logger_drops);
+    EXEC_TEST(test_logger_rate_limit);
+    EXEC_TEST(test_logger_rate_limit_flush);
     std::cout << "================================================================================" << std::endl;
     return TEST_PASS;
 }
@@ -16,6 +16,7 @@
 #include "tests.hpp"
 #include "../src/messages.hpp"
 #include <sstream>
+#include <tuple>
 using namespace cloudbus;
 static int test_cmp_uuid() {
     using namespace messages;
@@ -32,9 +33,28 @@ static int test_cmp_uuid() {
     FAIL_IF(sv4.str() == sv7.str());
     return TEST_PASS;
 }
+static int test_uuid_v7_monotonic() {
+    using namespace messages;
+    auto key = [](const uuid& id) {
+        std::uint64_t ms = (static_cast<std::uint64_t>(id.time_mid) << 32) | id.time_low;
+        return std::make_tuple(ms, id.time_high_version & TIME_HIGH_MAX);
+    };
+    auto prev = make_uuid_v7();
+    /* enough ids to overflow the counter within a millisecond. */
+    for(int i=0; i < 10000; ++i) {
+        auto next = make_uuid_v7();
+        FAIL_IF((next.time_high_version & ~TIME_HIGH_MAX) != 0x7000);
+        FAIL_IF((next.clock_seq_reserved & ~CLOCK_SEQ_MAX) != 0x80);
+        FAIL_IF(!(key(prev) < key(next)));
+        FAIL_IF(!uuidcmp_node(&prev, &next));
+        prev = next;
+    }
+    return TEST_PASS;
+}
 int main(int argc, char **argv) {
     std::cout << "================================= TEST MESSAGES ================================" << std::endl;
     EXEC_TEST(test_cmp_uuid);
+    EXEC_TEST(test_uuid_v7_monotonic);
     std::cout << "================================================================================" << std::endl;
     return TEST_PASS;
 }
\ No newline at end of file
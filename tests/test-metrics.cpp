@@ -15,6 +15,9 @@
 */
 #include "tests.hpp"
 #include "../src/metrics.hpp"
+#include "../src/metrics/metrics_histogram.hpp"
+#include "../src/metrics/metrics_loop.hpp"
+#include <thread>
 using namespace cloudbus;
 static int test_metrics_constructor() {
     auto& m1 = metrics::get();
@@ -46,44 +49,85 @@ static int test_metrics_get_arrivals() {
     metrics::get().erase_node(t2);
     return TEST_PASS;
 }
-static int test_metrics_get_streams() {
-    using clock_type = stream_metrics::clock_type;
-    using weak_ptr = stream_metrics::weak_ptr;
-    auto t = clock_type::now();
-    weak_ptr ptr;
-    auto interval = metrics::get().streams().add_arrival(ptr, t);
-    FAIL_IF(interval.count() != -1);
-    metrics::get().erase_node();
+static int test_metrics_recycle_node() {
+    std::size_t arrivals = 0;
+    node_metrics *first = nullptr, *second = nullptr;
+    std::thread([&](){
+        first = &metrics::get().make_node();
+        metrics::get().arrivals().fetch_add(1, std::memory_order_relaxed);
+        for(auto& m: metrics::get().get_all_measurements())
+            if(m.tid == std::this_thread::get_id())
+                arrivals = m.arrivals;
+        metrics::get().erase_node();
+    }).join();
+    FAIL_IF(arrivals != 1);
+    std::thread([&](){
+        second = &metrics::get().make_node();
+        arrivals = metrics::get().arrivals();
+        metrics::get().erase_node();
+    }).join();
+    FAIL_IF(first != second);
+    FAIL_IF(arrivals != 0);
+    FAIL_IF(!metrics::get().get_all_measurements().empty());
     return TEST_PASS;
 }
-static int test_metrics_add_arrival() {
-    using clock_type = stream_metrics::clock_type;
-    using duration_type = stream_metrics::duration_type;
-    using weak_ptr = stream_metrics::weak_ptr;
-    using shared_ptr = std::shared_ptr<stream_metrics::stream_type>;
-    shared_ptr sp = std::make_shared<stream_metrics::stream_type>();
-    weak_ptr wp = sp;
-    auto t = clock_type::now();
-    auto interval = metrics::get().streams().add_arrival(wp, t);
-    FAIL_IF(interval.count() != 0);
-    t += duration_type(100);
-    interval = metrics::get().streams().add_arrival(wp, t);
-    FAIL_IF(interval.count() != 50);
-    metrics::get().erase_node();
+static int test_histogram_percentiles() {
+    histogram h;
+    FAIL_IF(h.percentile(99) != 0);
+    for(histogram::value_type v=1; v <= 10000; ++v)
+        h.record(v);
+    FAIL_IF(h.count() != 10000);
+    /* percentiles are rounded up to within 1/16 of the value. */
+    for(double p: {50.0, 99.0, 99.9}) {
+        const double exact = p*100, value = h.percentile(p);
+        FAIL_IF(value < exact || value > exact*(1+1.0/16));
+    }
+    FAIL_IF(h.percentile(100) < 10000);
+    h.record(std::chrono::milliseconds(-1));
+    FAIL_IF(h.counts()[0] != 1);
+    h.record(std::chrono::hours(24));
+    FAIL_IF(h.counts().back() != 1);
+    for(std::size_t i=1; i < histogram::NBUCKETS; ++i) {
+        FAIL_IF(histogram::index(histogram::highest(i)) != i);
+        FAIL_IF(histogram::index(histogram::highest(i-1)+1) != i);
+    }
     return TEST_PASS;
 }
-static int test_metrics_add_completion() {
-    using clock_type = stream_metrics::clock_type;
-    using weak_ptr = stream_metrics::weak_ptr;
-    using shared_ptr = std::shared_ptr<stream_metrics::stream_type>;
-    shared_ptr sp = std::make_shared<stream_metrics::stream_type>();
-    weak_ptr wp = sp;
-    auto t = clock_type::now();
-    auto interval = metrics::get().streams().add_completion(wp, t);
-    FAIL_IF(interval.count() != 0);
-    const auto& m = metrics::get().streams().get_all_measurements();
-    FAIL_IF(m.size() != 1);
-    metrics::get().erase_node();
+static int test_histogram_merge() {
+    histogram a, b, both;
+    for(histogram::value_type v=0; v < 1000; ++v) {
+        (v%2 ? a : b).record(v*v);
+        both.record(v*v);
+    }
+    a += b;
+    FAIL_IF(a.count() != both.count());
+    FAIL_IF(a.counts() != both.counts());
+    FAIL_IF(a.percentile(99) != both.percentile(99));
+    a.reset();
+    FAIL_IF(a.count() || a.percentile(50));
+    return TEST_PASS;
+}
+static int test_loop_timer() {
+    std::uint64_t calls[2] = {}, ns = 0;
+    std::thread([&](){
+        auto& loop = loop_metrics::local();
+        /* nothing is timed until timing is switched on. */
+        {
+            loop_metrics::timer timer(loop_metrics::NORTH_POLLIN);
+        }
+        calls[0] = loop.handler_calls[loop_metrics::NORTH_POLLIN];
+        loop_metrics::timing() = true;
+        {
+            loop_metrics::timer timer(loop_metrics::NORTH_POLLIN);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        calls[1] = loop.handler_calls[loop_metrics::NORTH_POLLIN];
+        ns = loop.handler_ns[loop_metrics::NORTH_POLLIN];
+    }).join();
+    FAIL_IF(calls[0] != 0 || calls[1] != 1);
+    FAIL_IF(ns < 2000000);
+    /* each thread has its own metrics. */
+    FAIL_IF(loop_metrics::timing() || loop_metrics::local().handler_calls[loop_metrics::NORTH_POLLIN]);
     return TEST_PASS;
 }
 int main(int argc, char **argv) {
@@ -91,9 +135,10 @@ int main(int argc, char **argv) {
     EXEC_TEST(test_metrics_constructor);
     EXEC_TEST(test_metrics_make_node);
     EXEC_TEST(test_metrics_get_arrivals);
-    EXEC_TEST(test_metrics_get_streams);
-    EXEC_TEST(test_metrics_add_arrival);
-    EXEC_TEST(test_metrics_add_completion);
+    EXEC_TEST(test_metrics_recycle_node);
+    EXEC_TEST(test_histogram_percentiles);
+    EXEC_TEST(test_histogram_merge);
+    EXEC_TEST(test_loop_timer);
     std::cout << "================================================================================" << std::endl;
     return TEST_PASS;
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "tests.hpp"
+#include "../src/node.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <thread>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace cloudbus;
+static int listen_loopback(std::uint16_t& port) {
+    struct sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0)
+        return -1;
+    if( bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) ||
+        listen(fd, 8) ||
+        getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len)
+    ){
+        close(fd);
+        return -1;
+    }
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+static bool read_all(int fd, char *buf, std::size_t len) {
+    while(len) {
+        auto n = read(fd, buf, len);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+static bool write_all(int fd, const char *buf, std::size_t len) {
+    while(len) {
+        auto n = write(fd, buf, len);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+/* The backend answers with more than one frame's worth of data into *
+ * a north socket that can't take it all, so the splices come up     *
+ * short and the rest of each frame is copied out of the pipe.       */
+static int test_segment_splice_framing() {
+    constexpr std::size_t HDRLEN = sizeof(messages::msgheader), PAYLOAD = 1 << 20;
+    std::uint16_t backend_port = 0;
+    int backend = listen_loopback(backend_port);
+    FAIL_IF(backend < 0);
+    const config::section section = {
+        {"bind", "tcp://127.0.0.1:0"},
+        {"backend", "tcp://127.0.0.1:" + std::to_string(backend_port)},
+        {"passthrough", "on"}
+    };
+    FAIL_IF(!segment::connector::passthrough(section));
+    segment_type node(section);
+    const auto& listener = node.connector().north().front().streams().front();
+    struct sockaddr_in addr = {};
+    socklen_t addrlen = sizeof(addr);
+    FAIL_IF(getsockname(std::get<int>(listener), reinterpret_cast<struct sockaddr*>(&addr), &addrlen));
+    /* accepted sockets inherit the listener's send buffer. */
+    const int bufsize = 4096;
+    FAIL_IF(setsockopt(std::get<int>(listener), SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize)));
+
+    std::string payload(PAYLOAD, '\0');
+    for(std::size_t i = 0; i < payload.size(); ++i)
+        payload[i] = static_cast<char>(i * 131 + i / 251);
+    const std::string request = "request";
+    std::thread server([&]() {
+        int fd = accept(backend, nullptr, nullptr);
+        if(fd < 0)
+            return;
+        std::string buf(request.size(), '\0');
+        if(read_all(fd, buf.data(), buf.size()) && buf == request)
+            write_all(fd, payload.data(), payload.size());
+        close(fd);
+    });
+    int notify[2] = {-1, -1};
+    FAIL_IF(pipe(notify));
+    std::thread worker([&]() { node.run(notify[0]); });
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    auto exchange = [&]() {
+        FAIL_IF(client < 0);
+        FAIL_IF(setsockopt(client, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize)));
+        FAIL_IF(connect(client, reinterpret_cast<struct sockaddr*>(&addr), addrlen));
+        const auto eid = messages::make_uuid_v7();
+        const messages::msgheader head = {
+            eid,
+            {1, static_cast<std::uint16_t>(HDRLEN + request.size())},
+            {0, 0},
+            {messages::DATA, messages::INIT}
+        };
+        FAIL_IF(!write_all(client, reinterpret_cast<const char*>(&head), HDRLEN));
+        FAIL_IF(!write_all(client, request.data(), request.size()));
+        /* let the north socket fill up before reading anything. */
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        std::string received;
+        std::size_t frames = 0;
+        messages::msgheader frame = {};
+        do {
+            FAIL_IF(!read_all(client, reinterpret_cast<char*>(&frame), HDRLEN));
+            FAIL_IF(frame.eid != eid);
+            FAIL_IF(frame.len.length < HDRLEN);
+            const std::size_t len = frame.len.length - HDRLEN;
+            const auto off = received.size();
+            FAIL_IF(off + len > payload.size());
+            received.resize(off + len);
+            FAIL_IF(!read_all(client, received.data() + off, len));
+            /* stale pipe bytes would shift the payload. */
+            FAIL_IF(received.compare(off, len, payload, off, len));
+            ++frames;
+        } while(frame.type.op != messages::STOP);
+        FAIL_IF(received != payload);
+        FAIL_IF(frames < PAYLOAD / (UINT16_MAX - HDRLEN));
+
+        const messages::msgheader stop = {
+            eid, {2, static_cast<std::uint16_t>(HDRLEN)}, {0, 0}, {messages::STOP, 0}
+        };
+        FAIL_IF(!write_all(client, reinterpret_cast<const char*>(&stop), HDRLEN));
+        return TEST_PASS;
+    };
+    const int rc = exchange();
+    /* unblock the backend whether or not the exchange got that far. */
+    close(client);
+    shutdown(backend, SHUT_RDWR);
+    const int sig = SIGTERM;
+    write_all(notify[1], reinterpret_cast<const char*>(&sig), sizeof(sig));
+    worker.join();
+    server.join();
+    close(notify[0]);
+    close(notify[1]);
+    close(backend);
+    return rc;
+}
+
+int main(int argc, char **argv) {
+    std::signal(SIGPIPE, SIG_IGN);
+    EXEC_TEST(test_segment_splice_framing);
+    return status;
+}
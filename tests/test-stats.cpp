@@ -0,0 +1,159 @@
+/*
+*   Copyright 2025 Kevin Exton
+*   This file is part of Cloudbus.
+*
+*   Cloudbus is free software: you can redistribute it and/or modify it under the
+*   terms of the GNU General Public License as published by the Free Software
+*   Foundation, either version 3 of the License, or any later version.
+*
+*   Cloudbus is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*   See the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along with Cloudbus.
+*   If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "tests.hpp"
+#include "../src/stats.hpp"
+#include "../src/connectors.hpp"
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+using namespace cloudbus;
+static std::string test_path() {
+    return "/tmp/cloudbus-test-stats." + std::to_string(getpid());
+}
+static int test_stats_publish_read() {
+    const auto path = test_path();
+    stats::open(path, "test");
+    std::thread([&](){
+        stats::attach("service");
+        auto *s = stats::local();
+        if(!s)
+            return;
+        stats::node_record rec = s->record;
+        rec.arrivals = 42;
+        rec.sessions[stats::OPEN] = 3;
+        stats::publish(*s, rec);
+    }).join();
+    {
+        stats::reader r(path);
+        FAIL_IF(std::strcmp(r.head().component, "test"));
+        FAIL_IF(r.head().pid != getpid());
+        FAIL_IF(!r.alive());
+        std::size_t found = 0;
+        for(std::size_t i=0; i < r.size(); ++i) {
+            stats::node_record rec;
+            if(!stats::read(r[i], rec))
+                continue;
+            ++found;
+            FAIL_IF(std::strcmp(rec.service, "service"));
+            FAIL_IF(rec.arrivals != 42);
+            FAIL_IF(rec.sessions[stats::OPEN] != 3);
+            FAIL_IF(!rec.tid);
+        }
+        /* the thread never detached, so its slot is still in use. */
+        FAIL_IF(found != 1);
+    }
+    stats::close();
+    FAIL_IF(!access(path.c_str(), F_OK));
+    return TEST_PASS;
+}
+static int test_stats_detach() {
+    const auto path = test_path();
+    stats::open(path, "test");
+    stats::reader r(path);
+    stats::slot *first = nullptr, *second = nullptr;
+    std::thread([&](){
+        stats::attach("first");
+        first = stats::local();
+        stats::detach();
+    }).join();
+    std::thread([&](){
+        stats::attach("second");
+        second = stats::local();
+        stats::detach();
+    }).join();
+    stats::close();
+    FAIL_IF(!first || first != second);
+    stats::node_record rec;
+    FAIL_IF(stats::read(r[0], rec));
+    return TEST_PASS;
+}
+static int test_stats_seqlock() {
+    const auto path = test_path();
+    stats::open(path, "test");
+    std::atomic<bool> done{false};
+    std::thread writer([&](){
+        stats::attach("writer");
+        auto *s = stats::local();
+        stats::node_record rec = s->record;
+        rec.nbackends = stats::MAX_BACKENDS;
+        for(std::uint64_t i=1; i < 20000; ++i) {
+            rec.arrivals = rec.north_bytes = rec.south_bytes = i;
+            rec.backends[stats::MAX_BACKENDS-1].streams = i;
+            stats::publish(*s, rec);
+        }
+        done = true;
+    });
+    int torn = 0;
+    {
+        stats::reader r(path);
+        stats::node_record rec;
+        while(!done) {
+            if(!stats::read(r[0], rec))
+                continue;
+            if(rec.arrivals != rec.north_bytes ||
+                rec.arrivals != rec.south_bytes ||
+                rec.arrivals != rec.backends[stats::MAX_BACKENDS-1].streams
+            ){
+                ++torn;
+            }
+        }
+    }
+    writer.join();
+    stats::close();
+    FAIL_IF(torn);
+    return TEST_PASS;
+}
+static int test_stats_connector_publish() {
+    const auto path = test_path();
+    stats::open(path, "test");
+    const config::section section = {
+        {"bind", "tcp://127.0.0.1:0"},
+        {"backend", "tcp://127.0.0.1:9"},
+        {"backend", "unix:///tmp/cloudbus-test.sock"}
+    };
+    stats::node_record rec{};
+    std::thread([&](){
+        stats::attach("connector");
+        connector_base c(section);
+        c.north_bytes() = 10;
+        c.south_bytes() = 20;
+        const auto t = connector_base::clock_type::now();
+        c.publish(t);
+        /* publishes are rate limited, and a skipped one is due later. */
+        c.north_bytes() = 30;
+        c.publish(t);
+        if(c.publish_due() == connector_base::clock_type::time_point::max())
+            return;
+        rec = stats::local()->record;
+        stats::detach();
+    }).join();
+    stats::close();
+    FAIL_IF(rec.north_bytes != 10 || rec.south_bytes != 20);
+    FAIL_IF(rec.nbackends != 2);
+    FAIL_IF(std::strcmp(rec.backends[0].uri, "tcp://127.0.0.1:9"));
+    FAIL_IF(std::strcmp(rec.backends[1].uri, "unix:///tmp/cloudbus-test.sock"));
+    return TEST_PASS;
+}
+int main(int argc, char **argv) {
+    std::cout << "================================== TEST STATS ==================================" << std::endl;
+    EXEC_TEST(test_stats_publish_read);
+    EXEC_TEST(test_stats_detach);
+    EXEC_TEST(test_stats_seqlock);
+    EXEC_TEST(test_stats_connector_publish);
+    std::cout << "================================================================================" << std::endl;
+    return TEST_PASS;
+}